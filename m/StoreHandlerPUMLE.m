@@ -0,0 +1,87 @@
+classdef StoreHandlerPUMLE < handle
+%% StoreHandlerPUMLE
+%
+% Output handler for simulateScheduleAD that writes each converged state
+% to the HDF5 field store (see createStorePUMLE) as soon as it is ready,
+% in the style of MRST's ResultHandler:
+%
+%   handler = StoreHandlerPUMLE(fname, cumsum(schedule.step.val));
+%   wellSol = simulateScheduleAD(initState, model, schedule, ...
+%                                'OutputHandler', handler);
+%
+% Only the state being written is held in memory, and the steps already
+% written survive a failure later in the run. Indexing handler{i} reads
+% step i back from the store.
+%
+% Options: 'summary', ctx - also write the plume summary of each state
+%                           (plumeSummaryPUMLE over the summaryContextPUMLE
+%                           context ctx) to /summary
+%          'fields', false - write only the summary and the checkpoint
+%          'codec', codec  - encoding of the saturations (fieldCodecPUMLE)
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+    properties
+        fname    % store file
+        time     % simulated time at the end of each control step [s]
+        offset   % index in the store of the step before the first one
+        written  % store indices written so far
+        write_time % total wall time spent writing to the store [s]
+        summary  % plume summary context, [] for none
+        fields   % write the fields
+        codec    % saturation encoding and encoder state
+    end
+
+    methods
+        function handler = StoreHandlerPUMLE(fname, time, varargin)
+            opt = struct('offset', 0, 'summary', [], 'fields', true, 'codec', []);
+            opt = merge_options(opt, varargin{:});
+
+            handler.fname   = fname;
+            handler.time    = time;
+            handler.offset  = opt.offset;
+            handler.written = [];
+            handler.write_time = 0;
+            handler.summary = opt.summary;
+            handler.fields  = opt.fields;
+            handler.codec   = opt.codec;
+            if isempty(handler.codec), handler.codec = fieldCodecPUMLE(struct()); end
+        end
+
+        function handler = subsasgn(handler, s, v)
+            if strcmp(s(1).type, '{}')
+                i = s(1).subs{1};
+                t = tic;
+                summary = [];
+                if ~isempty(handler.summary), summary = plumeSummaryPUMLE(v, handler.summary); end
+                handler.codec = writeStepPUMLE(handler.fname, handler.offset + i, v, handler.time(i), ...
+                                               summary, handler.fields, handler.codec);
+                handler.write_time = handler.write_time + toc(t);
+                handler.written = union(handler.written, handler.offset + i);
+            else
+                handler = builtin('subsasgn', handler, s, v);
+            end
+        end
+
+        function varargout = subsref(handler, s)
+            if strcmp(s(1).type, '{}')
+                varargout{1} = readStepPUMLE(handler.fname, handler.offset + s(1).subs{1});
+            else
+                [varargout{1:nargout}] = builtin('subsref', handler, s);
+            end
+        end
+
+        function n = numelData(handler)
+            n = numel(handler.written);
+        end
+
+        function ids = getValidIds(handler)
+            ids = handler.written(:) - handler.offset;
+        end
+
+        function resetData(handler)
+            handler.written = [];
+        end
+    end
+end
@@ -0,0 +1,82 @@
+classdef WarmStartModelPUMLE < TwoPhaseWaterGasModel
+%% WarmStartModelPUMLE
+%
+% TwoPhaseWaterGasModel whose Newton iterations start each timestep from
+% the states of neighbouring completed cases (warmStartGuessPUMLE) instead
+% of the previous state. The guess is interpolated linearly in time within
+% each donor and weighted across donors; steps beyond the donors' schedule
+% keep the default start. Convergence is still checked against the model
+% tolerances, so the converged states agree with a cold start to within
+% them. Adaptive timestep selectors would pick other steps from the
+% changed iteration counts, so runCasePUMLE only warm-starts fixed
+% schedules.
+%
+% The elapsed time is carried in state.warm_time, set on the initial
+% state and advanced after each converged (mini)step, so cut timesteps
+% are interpolated at their own time.
+%
+% Usage: model = WarmStartModelPUMLE(model, guess)
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+properties
+    guess % struct array: time (1 x T), pressure and sg (cells x T), weight
+end
+
+methods
+    function model = WarmStartModelPUMLE(base, guess)
+        model = model@TwoPhaseWaterGasModel(base.G, base.rock, base.fluid, 0, 0);
+        % keep the operators, tolerances and backends of the base model
+        % (e.g. upscaled ones of a coarse model)
+        for p = properties(base)'
+            try
+                model.(p{1}) = base.(p{1});
+            catch
+                % dependent or read-only property
+            end
+        end
+        model.guess = guess;
+    end
+
+    function [model, state] = prepareTimestep(model, state, state0, dt, drivingForces)
+        [model, state] = prepareTimestep@TwoPhaseWaterGasModel(model, state, state0, dt, drivingForces);
+        if isempty(model.guess) || ~isfield(state0, 'warm_time')
+            return
+        end
+        t  = state0.warm_time + dt;
+        p  = zeros(size(state.pressure));
+        sg = zeros(size(state.pressure));
+        for d = 1:numel(model.guess)
+            g = model.guess(d);
+            if t > g.time(end) * (1 + 1e-9)
+                return
+            end
+            % bracketing stored steps; before the first one, the previous state
+            k = find(g.time >= t * (1 - 1e-9), 1);
+            if k == 1
+                t0 = 0;  p0 = state0.pressure;  sg0 = state0.s(:, 2);
+            else
+                t0 = g.time(k-1);  p0 = double(g.pressure(:, k-1));  sg0 = double(g.sg(:, k-1));
+            end
+            a  = (t - t0) / max(g.time(k) - t0, eps);
+            p  = p  + g.weight * ((1 - a) * p0  + a * double(g.pressure(:, k)));
+            sg = sg + g.weight * ((1 - a) * sg0 + a * double(g.sg(:, k)));
+        end
+        if any(~isfinite(p)) || any(~isfinite(sg))
+            return
+        end
+        sg = min(max(sg, 0), 1);
+        state.pressure = p;
+        state.s        = [1 - sg, sg];
+    end
+
+    function [state, report] = updateAfterConvergence(model, state0, state, dt, drivingForces)
+        [state, report] = updateAfterConvergence@TwoPhaseWaterGasModel(model, state0, state, dt, drivingForces);
+        if isfield(state0, 'warm_time')
+            state.warm_time = state0.warm_time + dt;
+        end
+    end
+end
+
+end
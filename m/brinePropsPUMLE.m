@@ -0,0 +1,65 @@
+function [rhow, muw] = brinePropsPUMLE(P, T, X_NaCl, rho_H2O)
+%% brinePropsPUMLE
+%
+% Brine density (Driesner, 2007) and viscosity (Mao & Duan, 2009), see the
+% references in co2lab3DPUMLE. Evaluated element-wise, so any of the
+% inputs may be arrays of compatible sizes (e.g. a pressure table).
+%
+%         P: pressure [MPa]
+%         T: temperature [º C]
+%    X_NaCl: NaCl mass fraction [ ]
+%   rho_H2O: pure water density [kg/m3]
+%
+%      rhow: brine density [kg/m3]
+%       muw: brine viscosity [Pa s] (independent of P)
+%
+% py/fluid_properties.py implements the same correlations in Python.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+% === Driesner correlation for brine density
+
+% coefficients
+[m0, m1, m2, m3, m4, m5] = deal(58443, 23.772, 0.018639, -1.9687e-6, -1.5259e-5, 5.5058e-8);
+
+rho_NaCl_0 = m0 ./ (m1 + m2.*T + m3.*T.^2);
+c_NaCl     = m4 + m5.*T;
+
+P_b      = 10*P; % pressure [bar];  MPa to bar : 1 MPa = 10 bar
+rho_NaCl = rho_NaCl_0 ./ ( 1 - 0.1*log(1 + 10*P_b .* c_NaCl) ); % salt density
+
+rhow = rho_H2O.*(1 - X_NaCl) + rho_NaCl.*X_NaCl; % brine density
+
+% === Mao & Duan correlation
+
+t_K = T + 273.15; % temperature, in Kelvin
+
+% NaCl molality [mol/kg]; molar mass 58.44 g/mol
+moly = X_NaCl ./ ( 58.44/1000 * (1 - X_NaCl) );
+
+% coefficients
+[a0, a1, a2, ...
+ b0, b1, b2, ...
+ c0, c1] = deal(-0.21319213, 0.13651589e-2, -0.12191756e-5, ...
+     0.69161945e-1, -0.27292263e-3, 0.20852448e-6, ...
+     -0.25988855e-2, 0.77989227e-5);
+
+A = a0 + a1.*t_K + a2.*t_K.^2;
+B = b0 + b1.*t_K + b2.*t_K.^2;
+C = c0 + c1.*t_K;
+
+% relative viscosity correlation
+mu_rel = exp( A.*moly + B.*moly.^2 + C.*moly.^3 );
+
+% water viscosity (rho_H2O in g/cm3)
+d = [ 0.28853170e7, -0.11072577e5, -0.90834095e1, 0.30925651e-1, -0.27407100e-4, ...
+      -0.19283851e7, 0.56216046e4, 0.13827250e2, -0.47609523e-1, 0.35545041e-4 ];
+
+log_mu = zeros(size(t_K));
+for i = 1:5,  log_mu = log_mu + d(i) .* t_K.^(i-3);                 end
+for i = 6:10, log_mu = log_mu + d(i) .* rho_H2O/1e3 .* t_K.^(i-8);  end
+
+muw = mu_rel .* exp(log_mu);
+
+end
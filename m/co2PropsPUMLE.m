@@ -0,0 +1,17 @@
+function co2 = co2PropsPUMLE()
+%% co2PropsPUMLE
+%
+% co2lab's CO2props() (sampled tables of CO2 density and viscosity),
+% loaded once per MATLAB session and reused afterwards, so that warm
+% engine sessions running many cases do not reload the tables each time.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+persistent cached
+if isempty(cached)
+    cached = CO2props();
+end
+co2 = cached;
+
+end
@@ -0,0 +1,88 @@
+%% co2lab3DBatchPUMLE
+%
+% Batch counterpart of co2lab3DPUMLE: runs the K cases of one case table
+% in a single MATLAB session. MRST, the grid, rock and trap analysis are
+% set up once, and the cases run in a parfor over the Parallel Computing
+% Toolbox workers of the session, each rebuilding only its fluid, initial
+% state, model, wells and schedule (runCasePUMLE). Without the toolbox the
+% parfor runs the cases one after the other.
+%
+% The case table BatchPUMLE.mat, exported by PUMLE
+% (GenerateDataset.run_batch), holds
+%
+%   cases:   cell array of K PARAMS structs sharing the same [Grid]
+%   workers: number of parallel workers (0 for the default pool size)
+%
+% The status of each case is written to batch_status.json.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+%% Loading the case table
+
+batch = load(fullfile('./', 'BatchPUMLE.mat'));
+cases = batch.cases;
+if isstruct(cases), cases = num2cell(cases); end
+K = numel(cases);
+
+fprintf('[MATLAB] PUMLE''s case table loaded: %d case(s).\n', K)
+
+
+%% General Settings
+
+t_run = tic;
+metrics.stages = struct();
+
+% Run MRST startup (for command line)
+t = tic;
+if ~exist('mrstModule','file')
+    run(fullfile(cases{1}.MATLAB.mrst_root,'startup.m'));
+end
+
+mrstModule add co2lab ad-core ad-props ad-blackoil;
+mrstVerbose off
+metrics.stages.mrst_startup = toc(t);
+
+
+%% Grid, rock models and trap analysis
+
+% Shared by all cases of the table
+[G, rock, Gt, trapSt, trap_volume, grid_timing] = loadGridPUMLE(cases{1});
+for f = fieldnames(grid_timing)', metrics.stages.(f{1}) = grid_timing.(f{1}); end
+
+
+%% Parallel pool
+
+t = tic;
+if license('test', 'Distrib_Computing_Toolbox') && isempty(gcp('nocreate'))
+    if batch.workers > 0
+        parpool('local', batch.workers);
+    else
+        parpool('local');
+    end
+end
+metrics.stages.pool_startup = toc(t);
+t_shared = toc(t_run);
+
+
+%% Cases
+
+status  = repmat({'failed'}, 1, K);
+message = repmat({''}, 1, K);
+
+parfor k = 1:K
+    try
+        runCasePUMLE(cases{k}, G, rock, Gt, trapSt, trap_volume, metrics, t_shared);
+        status{k} = 'done';
+    catch err
+        message{k} = err.message;
+        fprintf('[MATLAB] Case ''%s'' failed: %s\n', cases{k}.PreProcessing.case_name, err.message);
+    end
+end
+
+names = reshape(cellfun(@(c) c.PreProcessing.case_name, cases, 'UniformOutput', false), 1, []);
+fid = fopen('batch_status.json', 'w');
+fwrite(fid, jsonencode(struct('case_name', names, 'status', status, 'message', message)));
+fclose(fid);
+
+fprintf('[MATLAB] Batch completed: %d of %d case(s) done.\n', sum(strcmp(status, 'done')), K)
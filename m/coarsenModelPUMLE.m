@@ -0,0 +1,38 @@
+function [model, initState, toModel] = coarsenModelPUMLE(model, initState, coarsen)
+%% coarsenModelPUMLE
+%
+% Coarsened counterpart of the fine 3D model, for cheap mid-fidelity runs.
+% The grid from processGRDECL is partitioned into blocks of coarsen =
+% [ci cj ck] fine cells (partitionUI), blocks split by inactive cells are
+% separated (processPartition), and the model is upscaled with
+% upscaleModelTPFA (pore volumes and transmissibilities from the fine rock
+% permeability and porosity). The initial state is upscaled to the coarse
+% grid as well, and toModel upscales the wells/boundary conditions of a
+% fine-grid schedule (upscaleSchedule).
+%
+% The coarse grid model.G keeps the fine grid in model.G.parent and the
+% fine-to-coarse cell mapping in model.G.partition, which is stored with
+% the results (see createStorePUMLE).
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+mrstModule add coarsegrid upscaling;
+
+G = model.G;
+
+% Logically Cartesian partition, with disconnected blocks split
+p = partitionUI(G, coarsen);
+p = processPartition(G, p);
+p = compressPartition(p);
+
+% Coarse model and state
+fineModel = model;
+model     = upscaleModelTPFA(fineModel, p);
+initState = upscaleState(model, fineModel, initState);
+initState.sGmax = initState.s(:,2);
+toModel   = @(schedule) upscaleSchedule(model, schedule);
+
+fprintf('[MATLAB] Grid coarsened from %d to %d cells.\n', G.cells.num, model.G.cells.num)
+
+end
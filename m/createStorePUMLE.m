@@ -0,0 +1,146 @@
+function createStorePUMLE(fname, G, opts)
+%% createStorePUMLE
+%
+% Creates the HDF5 field store of a simulation (replaces the JSON dump of
+% the states cell array). Fields are stored as float32 over active cells
+% only, one chunk per timestep, so that readers can slice timesteps
+% without parsing the whole file. Timesteps are appended by writeStepPUMLE.
+%
+% Layout (dimensions as seen from MATLAB; h5py sees them reversed, i.e.
+% fields are [nsteps x ncells] in Python):
+%
+%   /pressure, /sW, /sG, /sGmax : single [ncells x nsteps]; with the
+%                                  [Output] quantize/delta/sparse options,
+%                                  the saturations are encoded instead
+%                                  (attribute 'codec', see
+%                                  fieldCodecPUMLE):
+%     quant16                      uint16 [ncells x nsteps], value/65535
+%     quant16-delta                int32 [ncells x nsteps], difference to
+%                                  the previous step, absolute every
+%                                  'keyframe_interval' steps
+%     sparse, sparse-quant16       group with index (int32, 1-based cell),
+%                                  values (single or uint16) [1 x nnz]
+%                                  and ptr (int64 [2 x nsteps], 0-based
+%                                  start and count of each step)
+%   /time                        : double [1 x nsteps], simulated time [s]
+%   /grid/cartDims               : int32  [1 x ndims]
+%   /grid/indexMap               : int32  [ncells x 1], active cell to
+%                                  linear Cartesian index (1-based)
+%   /grid/partition              : int32  [nfine x 1], coarse runs only:
+%                                  coarse cell of each fine active cell
+%                                  (1-based); indexMap and cartDims are
+%                                  then those of the fine grid
+%   /checkpoint/pressure, /s,    : double, last written state at full
+%    /sGmax                        precision (attribute 'step'), used to
+%                                  restart an interrupted run
+%   /summary/<name>              : double [1 x nsteps], plume summary of
+%                                  each timestep (plumeSummaryPUMLE), with
+%                                  the surface CO2 density as attribute
+%                                  'rhoGS' (opts.rhoGS)
+%
+% opts.compression: deflate level, 0 for none.
+% opts.fidelity   : model the fields come from, '3d', 'coarse' or 've'
+%                   (stored as the root attribute 'fidelity'). For 've', G
+%                   is the top surface grid Gt and the fields are over its
+%                   columns; for 'coarse', G is a coarse grid and the
+%                   fields are over its blocks.
+% opts.fields     : write the fields (default true); with false, the store
+%                   holds only the time, grid, checkpoint and summary.
+% opts.summary_fields: names of the summary series to create.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+if exist(fname, 'file'), delete(fname); end
+
+n = G.cells.num;
+
+args = {};
+if opts.compression > 0
+    args = {'Deflate', opts.compression, 'Shuffle', true};
+end
+
+if ~isfield(opts, 'fields') || logical(opts.fields)
+    h5create(fname, '/pressure', [n Inf], 'Datatype', 'single', 'ChunkSize', [n 1], args{:});
+
+    % saturations with the encoding of fieldCodecPUMLE; readers decode
+    % them from the 'codec' attribute of each field
+    codec = fieldCodecPUMLE(opts);
+    for f = {'sW', 'sG', 'sGmax'}
+        c = codec.(f{1});
+        path = ['/', f{1}];
+        switch c.kind
+            case 'float32'
+                h5create(fname, path, [n Inf], 'Datatype', 'single', 'ChunkSize', [n 1], args{:});
+                err = eps('single') / 2;
+            case 'quant16'
+                h5create(fname, path, [n Inf], 'Datatype', 'uint16', 'ChunkSize', [n 1], args{:});
+                err = 0.5 / 65535;
+            case 'quant16-delta'
+                h5create(fname, path, [n Inf], 'Datatype', 'int32', 'ChunkSize', [n 1], args{:});
+                h5writeatt(fname, path, 'keyframe_interval', int32(c.keyframe));
+                err = 0.5 / 65535;
+            case {'sparse', 'sparse-quant16'}
+                vtype = 'single'; err = c.eps;
+                if strcmp(c.kind, 'sparse-quant16'), vtype = 'uint16'; err = max(c.eps, 0.5 / 65535); end
+                chunk = max(1024, min(n, 65536));
+                h5create(fname, [path, '/index'],  [1 Inf], 'Datatype', 'int32', 'ChunkSize', [1 chunk], args{:});
+                h5create(fname, [path, '/values'], [1 Inf], 'Datatype', vtype,   'ChunkSize', [1 chunk], args{:});
+                h5create(fname, [path, '/ptr'],    [2 Inf], 'Datatype', 'int64', 'ChunkSize', [2 64]);
+                h5writeatt(fname, path, 'n_cells', int32(n));
+                h5writeatt(fname, path, 'eps', c.eps);
+        end
+        h5writeatt(fname, path, 'codec', c.kind);
+        h5writeatt(fname, path, 'max_abs_error', err);
+    end
+end
+h5create(fname, '/time', [1 Inf], 'Datatype', 'double', 'ChunkSize', [1 64]);
+
+if isfield(opts, 'summary_fields')
+    for i = 1:numel(opts.summary_fields)
+        h5create(fname, ['/summary/', opts.summary_fields{i}], [1 Inf], ...
+                 'Datatype', 'double', 'ChunkSize', [1 64]);
+    end
+    % surface CO2 density, to convert the injected volume to mass
+    if isfield(opts, 'rhoGS'), h5writeatt(fname, '/summary', 'rhoGS', opts.rhoGS); end
+end
+
+% Grid metadata, once per file. Coarse grids (generateCoarseGrid) are
+% stored with the fine grid layout and the fine-to-coarse partition
+if isfield(G, 'parent')
+    Gm = G.parent;
+else
+    Gm = G;
+end
+
+h5create(fname, '/grid/cartDims', [1 numel(Gm.cartDims)], 'Datatype', 'int32');
+h5write(fname, '/grid/cartDims', int32(Gm.cartDims(:)'));
+
+% top surface grids may only carry the (i, j) index of each column
+if isfield(Gm.cells, 'indexMap')
+    indexMap = Gm.cells.indexMap(:);
+else
+    indexMap = sub2ind(Gm.cartDims, Gm.cells.ij(:,1), Gm.cells.ij(:,2));
+end
+h5create(fname, '/grid/indexMap', [numel(indexMap) 1], 'Datatype', 'int32');
+h5write(fname, '/grid/indexMap', int32(indexMap));
+
+if isfield(G, 'parent')
+    h5create(fname, '/grid/partition', [numel(G.partition) 1], 'Datatype', 'int32');
+    h5write(fname, '/grid/partition', int32(G.partition(:)));
+end
+
+% Restart checkpoint, overwritten at each timestep
+h5create(fname, '/checkpoint/pressure', [n 1], 'Datatype', 'double');
+h5create(fname, '/checkpoint/s',        [n 2], 'Datatype', 'double');
+h5create(fname, '/checkpoint/sGmax',    [n 1], 'Datatype', 'double');
+h5writeatt(fname, '/checkpoint', 'step', int32(0));
+
+h5writeatt(fname, '/', 'format', 'pumle-store');
+h5writeatt(fname, '/', 'version', int32(1));
+
+fidelity = '3d';
+if isfield(opts, 'fidelity'), fidelity = opts.fidelity; end
+h5writeatt(fname, '/', 'fidelity', fidelity);
+
+end
@@ -0,0 +1,66 @@
+function codec = fieldCodecPUMLE(opts, fname, step0, state0)
+%% fieldCodecPUMLE
+%
+% Encoding of the saturation fields of the HDF5 field store, from the
+% [Output] options:
+%
+%   opts.quantize: store sW, sG and sGmax as 16-bit integers, value =
+%                  q / 65535, with a maximum absolute error of 0.5/65535
+%   opts.delta:    with quantize, store the difference of the integers to
+%                  the previous timestep, with an absolute keyframe every
+%                  opts.keyframe_interval steps for random access
+%   opts.sparse:   store sG and sGmax only where they exceed
+%                  opts.sparse_eps (cell index, value); smaller values
+%                  are read back as 0
+%
+% Pressure is always stored as float32. Returns one entry per saturation
+% field with its kind ('float32', 'quant16', 'quant16-delta', 'sparse' or
+% 'sparse-quant16') and the encoder state used by writeFieldPUMLE. When
+% restarting from timestep step0 of the store fname, the state is seeded
+% from the checkpoint state0 and the sparse index of the store.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+defaults = struct('quantize', false, 'delta', false, 'sparse', false, ...
+                  'sparse_eps', 1e-6, 'keyframe_interval', 10);
+for f = fieldnames(defaults)'
+    if isfield(opts, f{1}), defaults.(f{1}) = opts.(f{1}); end
+end
+opts = defaults;
+
+dense = 'float32';
+if logical(opts.quantize)
+    dense = 'quant16';
+    if logical(opts.delta), dense = 'quant16-delta'; end
+end
+
+codec = struct();
+for f = {'sW', 'sG', 'sGmax'}
+    kind = dense;
+    if logical(opts.sparse) && ~strcmp(f{1}, 'sW')
+        kind = 'sparse';
+        if logical(opts.quantize), kind = 'sparse-quant16'; end
+    end
+    codec.(f{1}) = struct('kind', kind, 'eps', opts.sparse_eps, ...
+                          'keyframe', opts.keyframe_interval, 'prev', [], 'next', 0);
+end
+
+% restart: previous integers from the checkpoint (the same state that
+% was encoded at step0), next free position of the sparse datasets
+if nargin > 1 && step0 > 0
+    values = struct('sW', state0.s(:,1), 'sG', state0.s(:,2), 'sGmax', state0.sGmax);
+    for f = fieldnames(codec)'
+        c = codec.(f{1});
+        switch c.kind
+            case 'quant16-delta'
+                c.prev = quantize16PUMLE(values.(f{1}));
+            case {'sparse', 'sparse-quant16'}
+                ptr = h5read(fname, ['/', f{1}, '/ptr'], [1 step0], [2 1]);
+                c.next = double(ptr(1) + ptr(2));
+        end
+        codec.(f{1}) = c;
+    end
+end
+
+end
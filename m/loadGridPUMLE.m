@@ -0,0 +1,96 @@
+function [G, rock, Gt, trapSt, trap_volume, timing] = loadGridPUMLE(PARAMS)
+%% loadGridPUMLE
+%
+% Builds the grid, rock and trap analysis of the model defined in the
+% [Grid] section of PUMLE's setup, i.e. readGRDECL (or the binary side-car
+% in PARAMS.Grid.sidecar_path, when present), convertInputUnits,
+% processGRDECL, computeGeometry, grdecl2Rock, topSurfaceGrid and
+% trapAnalysis/volumesOfTraps.
+%
+% None of these depend on the Fluid/Wells/Schedule parameters, so the
+% results are cached in a binary .mat file keyed by PARAMS.Grid.cache_key
+% (hash of the deck contents plus repair flag, computed by
+% py/grid_cache.py) inside PARAMS.Grid.cache_dir. On a hit, the file is
+% loaded instead. Without a cache key, the grid is always rebuilt.
+%
+% timing: wall time [s] of each stage run (grid_cache_load, read_grdecl,
+% process_grdecl, trap_analysis, grid_cache_save).
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+use_cache = isfield(PARAMS.Grid, 'cache_key') && ~isempty(PARAMS.Grid.cache_key);
+timing = struct();
+
+if use_cache
+    cache_file = fullfile(PARAMS.Grid.cache_dir, ...
+                          strcat('grid_', PARAMS.Grid.cache_key, '.mat'));
+    if exist(cache_file, 'file')
+        t = tic;
+        load(cache_file, 'G', 'rock', 'Gt', 'trapSt', 'trap_volume');
+        timing.grid_cache_load = toc(t);
+        fprintf('[MATLAB] Grid loaded from cache ''%s''.\n', cache_file)
+        return
+    end
+end
+
+%% Grid and rock models
+
+% The binary side-car of the deck (py/grdecl_parser.py) is preferred over
+% parsing the text deck
+t = tic;
+if isfield(PARAMS.Grid, 'sidecar_path') && exist(PARAMS.Grid.sidecar_path, 'file')
+    grdecl = readGRDECLSidecarPUMLE(PARAMS.Grid.sidecar_path);
+else
+    grdecl = readGRDECL(PARAMS.Grid.file_path);
+end
+
+% SI
+usys = getUnitSystem('METRIC');
+grdecl = convertInputUnits(grdecl, usys);
+timing.read_grdecl = toc(t);
+
+% Convert to logical
+repair_flag = PARAMS.Grid.repair_flag;
+if ischar(repair_flag)
+    repair_flag = any(strcmp(repair_flag, {'true', 'True'}));
+end
+
+t = tic;
+G = processGRDECL(grdecl,'RepairZCORN', repair_flag);
+G = computeGeometry(G);
+
+rock = grdecl2Rock(grdecl, G.cells.indexMap);
+
+% prevents zero poreVolume by setting a residual in cells below the least
+% nonzero value
+rock.poro(rock.poro < min(rock.poro(rock.poro > 0)) ) = 1e-3;
+rock.ntg(rock.ntg < min(rock.ntg(rock.ntg > 0)) ) = 1e-3;
+timing.process_grdecl = toc(t);
+
+%% Trap Analysis
+
+t = tic;
+Gt = topSurfaceGrid(G);
+
+trapSt = trapAnalysis(Gt,false);
+trap_volume = volumesOfTraps(Gt,trapSt,unique(trapSt.traps(trapSt.traps>0)));
+timing.trap_analysis = toc(t);
+
+%% Store in cache
+
+if use_cache
+    t = tic;
+    if ~exist(PARAMS.Grid.cache_dir, 'dir'), mkdir(PARAMS.Grid.cache_dir); end
+
+    % write to a temporary file first so that concurrent runs never load a
+    % partially written cache entry
+    tmp_file = fullfile(PARAMS.Grid.cache_dir, ...
+                        sprintf('grid_%s_%d.tmp.mat', PARAMS.Grid.cache_key, feature('getpid')));
+    save(tmp_file, 'G', 'rock', 'Gt', 'trapSt', 'trap_volume', '-v7.3');
+    movefile(tmp_file, cache_file, 'f');
+    timing.grid_cache_save = toc(t);
+    fprintf('[MATLAB] Grid stored in cache ''%s''.\n', cache_file)
+end
+
+end
@@ -0,0 +1,37 @@
+function wells = parseWellsPUMLE(wells_list, rate)
+%% parseWellsPUMLE
+%
+% Parses the [Wells] wells_list of PUMLE's setup into a struct array with
+% one entry per well. Wells are separated by '&' and given by their
+% logical grid coordinates, with an optional injection rate:
+%
+%   'NA1A: (38, 36, 6, 11) & RJS16: (12, 14, 6, 11, 1e5)'
+%
+%   (I, J, K_min, K_max[, rate])
+%
+%   rate: injection rate [m^3/year] of the wells without their own rate
+%         ([Wells] CO2_inj)
+%
+% Returns the fields name, ij = [I J], layers = K_min:K_max and rate
+% [m^3/year] of each well.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+tokens = regexp(wells_list, '([\w-]+)\s*:\s*\(([^)]*)\)', 'tokens');
+if isempty(tokens)
+    error('No well found in wells_list ''%s''.', wells_list);
+end
+
+wells = struct('name', {}, 'ij', {}, 'layers', {}, 'rate', {});
+for i = 1:numel(tokens)
+    v = str2double(strsplit(tokens{i}{2}, ','));
+    if ~any(numel(v) == [4 5]) || any(isnan(v)) || v(3) > v(4)
+        error('Invalid well ''%s'': expected (I, J, K_min, K_max[, rate]).', tokens{i}{1});
+    end
+    r = rate;
+    if numel(v) == 5, r = v(5); end
+    wells(i) = struct('name', tokens{i}{1}, 'ij', v(1:2), 'layers', v(3):v(4), 'rate', r);
+end
+
+end
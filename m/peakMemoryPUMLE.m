@@ -0,0 +1,23 @@
+function mb = peakMemoryPUMLE()
+%% peakMemoryPUMLE
+%
+% Peak resident memory [MB] of the MATLAB process so far (VmHWM from
+% /proc) on Linux. On Windows, the memory currently used by MATLAB is
+% returned instead; NaN elsewhere. In a warm engine session the peak
+% covers all the cases run by that session.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+mb = NaN;
+
+if exist('/proc/self/status', 'file')
+    txt = fileread('/proc/self/status');
+    tok = regexp(txt, 'VmHWM:\s*(\d+)\s*kB', 'tokens', 'once');
+    if ~isempty(tok), mb = str2double(tok{1}) / 1024; end
+elseif ispc
+    m = memory();
+    mb = m.MemUsedMATLAB / 1024^2;
+end
+
+end
@@ -0,0 +1,66 @@
+function s = plumeSummaryPUMLE(state, ctx)
+%% plumeSummaryPUMLE
+%
+% Scalar summary of the CO2 plume in one state, over the context built by
+% summaryContextPUMLE:
+%
+%   footprint_area      area of the columns holding CO2 (sG >= threshold) [m^2]
+%   extent_x, extent_y  horizontal extent of the plume [m]
+%   max_sg              maximum CO2 saturation
+%   co2_mass            CO2 mass in place [kg], split into
+%     residual_mass     CO2 below the residual saturation src (immobile)
+%     structural_mass   mobile CO2 in structural traps, above their spill point
+%     free_mass         mobile CO2 outside traps
+%   trap_fill           structurally trapped CO2 volume / trap pore volume
+%   max_dp_wells        maximum pressure buildup in well cells [Pa]
+%   max_dp_boundary     maximum pressure buildup in boundary cells [Pa]
+%   max_dp              maximum pressure buildup [Pa]
+%
+% ctx.threshold sets the saturation of plume cells (default 0.01).
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+threshold = 0.01;
+if isfield(ctx, 'threshold'), threshold = ctx.threshold; end
+
+% saturations and densities on fine cells (or columns)
+sG  = state.s(ctx.map, 2);
+rho = ctx.rhoG(state.pressure(ctx.map));
+
+plume = sG >= threshold;
+cols  = unique(ctx.col(plume & ctx.col > 0));
+s.footprint_area = sum(ctx.area(cols));
+if any(plume)
+    xy = ctx.xy(plume, :);
+    s.extent_x = max(xy(:,1)) - min(xy(:,1));
+    s.extent_y = max(xy(:,2)) - min(xy(:,2));
+else
+    s.extent_x = 0;
+    s.extent_y = 0;
+end
+s.max_sg = max(sG);
+
+residual = min(sG, ctx.src);
+mobile   = sG - residual;
+mass     = @(sat) sum(ctx.pv .* sat .* rho);
+
+s.co2_mass        = mass(sG);
+s.residual_mass   = mass(residual);
+s.structural_mass = mass(mobile .* ctx.trapped);
+s.free_mass       = s.co2_mass - s.residual_mass - s.structural_mass;
+s.trap_fill       = 0;
+if ctx.trap_capacity > 0
+    s.trap_fill = sum(ctx.pv .* mobile .* ctx.trapped) / ctx.trap_capacity;
+end
+
+dp = state.pressure - ctx.p0;
+s.max_dp_wells    = maxOrZero(dp(ctx.well_cells));
+s.max_dp_boundary = maxOrZero(dp(ctx.bc_cells));
+s.max_dp          = maxOrZero(dp);
+
+end
+
+function v = maxOrZero(x)
+if isempty(x), v = 0; else, v = max(x); end
+end
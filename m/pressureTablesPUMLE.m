@@ -0,0 +1,41 @@
+function fluid = pressureTablesPUMLE(fluid, co2, opts)
+%% pressureTablesPUMLE
+%
+% Replaces the constant-compressibility densities and constant viscosities
+% of a fluid made by initSimpleADIFluid with pressure-dependent ones,
+% interpolated from tables sampled once at the reference temperature:
+%
+%   bW(p) = rhow(p) / rhow(p_ref)    brine, Driesner (brinePropsPUMLE)
+%   bG(p) = rhoG(p) / rhoG(p_ref)    CO2, CO2props
+%   muG(p)                           CO2, CO2props
+%
+% The brine viscosity of Mao & Duan does not depend on pressure and stays
+% constant. Tables are evaluated with interpTable, which supports ADI
+% variables, so the cost per cell is one interpolation.
+%
+%   opts: struct with fields p_ref [Pa], T [º C], X_NaCl, rho_H2O and
+%         rhoc (CO2 density at p_ref), pmin/pmax [Pa] (table range) and
+%         points (number of samples)
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+p = linspace(opts.pmin, opts.pmax, opts.points)';
+t_K = opts.T + 273.15;
+
+% brine density, relative to the reference pressure
+rhow_p   = brinePropsPUMLE(p / (mega * Pascal), opts.T, opts.X_NaCl, opts.rho_H2O);
+rhow_ref = brinePropsPUMLE(opts.p_ref / (mega * Pascal), opts.T, opts.X_NaCl, opts.rho_H2O);
+
+% CO2 density and viscosity
+rhoG_p = co2.rho(p, repmat(t_K, size(p)));
+muG_p  = co2.mu(p, repmat(t_K, size(p))) * Pascal * second;
+
+fluid.bW  = @(pw, varargin) interpTable(p, rhow_p / rhow_ref, pw);
+fluid.bG  = @(pg, varargin) interpTable(p, rhoG_p / opts.rhoc, pg);
+fluid.muG = @(pg, varargin) interpTable(p, muG_p, pg);
+
+fprintf('[MATLAB] Pressure-dependent fluid tables: %d points in [%g, %g] MPa.\n', ...
+        opts.points, opts.pmin / (mega * Pascal), opts.pmax / (mega * Pascal))
+
+end
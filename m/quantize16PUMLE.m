@@ -0,0 +1,13 @@
+function q = quantize16PUMLE(v)
+%% quantize16PUMLE
+%
+% 16-bit quantization of saturations in [0, 1]: q = round(v * 65535),
+% as int32 so that differences between timesteps do not overflow. The
+% maximum absolute error of q / 65535 is 0.5/65535 (about 7.6e-6).
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+q = int32(round(min(max(v(:), 0), 1) * 65535));
+
+end
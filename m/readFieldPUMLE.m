@@ -0,0 +1,49 @@
+function v = readFieldPUMLE(fname, name, step)
+%% readFieldPUMLE
+%
+% Reads timestep step of a field of the HDF5 field store, decoding the
+% encodings of fieldCodecPUMLE (attribute 'codec'), as double.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+path = ['/', name];
+try
+    kind = h5readatt(fname, path, 'codec');
+catch
+    kind = 'float32';
+end
+
+switch kind
+    case 'float32'
+        info = h5info(fname, path);
+        v = double(h5read(fname, path, [1 step], [info.Dataspace.Size(1) 1]));
+
+    case 'quant16'
+        info = h5info(fname, path);
+        v = double(h5read(fname, path, [1 step], [info.Dataspace.Size(1) 1])) / 65535;
+
+    case 'quant16-delta'
+        info = h5info(fname, path);
+        n = info.Dataspace.Size(1);
+        K = double(h5readatt(fname, path, 'keyframe_interval'));
+        key = floor((step - 1) / K) * K + 1;
+        d = h5read(fname, path, [1 key], [n step - key + 1]);
+        v = double(sum(d, 2)) / 65535;
+
+    case {'sparse', 'sparse-quant16'}
+        n   = double(h5readatt(fname, path, 'n_cells'));
+        ptr = double(h5read(fname, [path, '/ptr'], [1 step], [2 1]));
+        v = zeros(n, 1);
+        if ptr(2) > 0
+            idx  = h5read(fname, [path, '/index'],  [1 ptr(1)+1], [1 ptr(2)]);
+            vals = double(h5read(fname, [path, '/values'], [1 ptr(1)+1], [1 ptr(2)]));
+            if strcmp(kind, 'sparse-quant16'), vals = vals / 65535; end
+            v(double(idx)) = vals;
+        end
+
+    otherwise
+        error('Unknown codec ''%s'' of field ''%s'' in ''%s''.', kind, name, fname);
+end
+
+end
@@ -0,0 +1,44 @@
+function grdecl = readGRDECLSidecarPUMLE(fname)
+%% readGRDECLSidecarPUMLE
+%
+% Reads the grid keywords of a deck from the binary side-car file written
+% by py/grdecl_parser.py (GRDECLParser.write_sidecar) and returns them in
+% the same structure as readGRDECL, ready for convertInputUnits.
+%
+% Layout: 8-byte magic 'PUMLEGRD', uint64 header length, JSON header with
+% dtype/count/offset of each array, then the raw little-endian arrays. The
+% arrays are memory-mapped rather than parsed.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+fid = fopen(fname, 'r', 'ieee-le');
+if fid < 0
+    error('PUMLE:sidecar', 'Cannot open GRDECL side-car ''%s''.', fname);
+end
+cleanup = onCleanup(@() fclose(fid));
+
+magic = fread(fid, [1 8], '*char');
+if ~strcmp(magic, 'PUMLEGRD')
+    error('PUMLE:sidecar', '''%s'' is not a PUMLE GRDECL side-car file.', fname);
+end
+hlen = fread(fid, 1, 'uint64=>double');
+header = jsondecode(fread(fid, [1 hlen], '*char'));
+
+% numpy dtype names to MATLAB classes
+types = struct('float64', 'double', 'float32', 'single', 'int32', 'int32');
+
+grdecl = struct();
+names = fieldnames(header.arrays);
+for i = 1:numel(names)
+    meta = header.arrays.(names{i});
+    m = memmapfile(fname, 'Offset', meta.offset, 'Writable', false, ...
+                   'Format', {types.(meta.dtype), [meta.count 1], 'x'});
+    grdecl.(names{i}) = double(m.Data.x);
+end
+
+grdecl.cartDims = reshape(grdecl.cartDims, 1, []);
+
+fprintf('[MATLAB] GRDECL side-car ''%s'' loaded.\n', fname)
+
+end
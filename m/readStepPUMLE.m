@@ -0,0 +1,19 @@
+function state = readStepPUMLE(fname, step)
+%% readStepPUMLE
+%
+% Reads one timestep back from the HDF5 field store written by
+% writeStepPUMLE, as an MRST state (pressure, s = [sW, sG], sGmax, time).
+% Values are the stored fields, decoded (readFieldPUMLE) and converted to
+% double.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+rd = @(name) readFieldPUMLE(fname, name, step);
+
+state.pressure = rd('pressure');
+state.s        = [rd('sW'), rd('sG')];
+state.sGmax    = rd('sGmax');
+state.time     = h5read(fname, '/time', [1 step], [1 1]);
+
+end
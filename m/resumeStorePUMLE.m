@@ -0,0 +1,30 @@
+function [state, step] = resumeStorePUMLE(fname)
+%% resumeStorePUMLE
+%
+% Reads the restart checkpoint of an HDF5 field store written by
+% writeStepPUMLE. Returns the last complete state (pressure, s, sGmax) at
+% full precision and its timestep index, or step = 0 and an empty state
+% when the store is missing or has no checkpoint.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+state = [];
+step  = 0;
+
+if ~exist(fname, 'file'), return; end
+
+try
+    step = double(h5readatt(fname, '/checkpoint', 'step'));
+catch
+    % store written before checkpoints were added, or not a store
+    return
+end
+
+if step > 0
+    state.pressure = h5read(fname, '/checkpoint/pressure');
+    state.s        = h5read(fname, '/checkpoint/s');
+    state.sGmax    = h5read(fname, '/checkpoint/sGmax');
+end
+
+end
@@ -0,0 +1,581 @@
+function runCasePUMLE(PARAMS, G, rock, Gt, trapSt, trap_volume, metrics, t_shared)
+%% runCasePUMLE
+%
+% Simulates one PUMLE case on a loaded grid: builds the fluid, initial
+% state, boundary conditions, model, solver, wells and schedule from
+% PARAMS, runs the simulation and writes the states and
+% matlab_metrics.json to the case folder, with the plume summary of each
+% timestep (plumeSummaryPUMLE) in the store and in summary_<case>.csv. The
+% grid, rock, top surface grid and trap analysis (loadGridPUMLE) are
+% inputs, so that a session can run several cases on the same grid
+% (co2lab3DBatchPUMLE).
+%
+%   metrics:  stage timings of the shared setup (MRST startup, grid)
+%   t_shared: wall time of the shared setup [s]
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+% loaded once per session; also for Parallel Computing Toolbox workers
+mrstModule add co2lab ad-core ad-props ad-blackoil;
+
+t_case = tic;
+case_name = PARAMS.PreProcessing.case_name;
+
+%% Fluid model
+
+%{
+
+------------------------------
+REFERENCE FOR FLUID PROPERTIES
+------------------------------
+
+PRESSURE (p):
+    Namorado depth range: [2881.20, 3356.3] m => Average depth = h_ave = 3090.20 m
+    p @h_ave: P = 0.1 [MPa] + 10 [MPa/km] x 3.902 [km] = 39.12 MPa
+    p-range: [28.91, 33.46] MPa
+
+TEMPERATURE (T):
+    T @(h_ave): T = 4 [ºC] + 23.36 [ºC/km] x 3.902 [km] = 95.15 [ºC] =
+    368.30 [ºK]
+
+
+Background:
+
+
+We use information provided in Ciotta's [R1] dissertation, pp. 139-140
+to estimate density, pressure and temperature for CO2 in reservoir
+conditions. The modeling is applied to Santos Basin, but with data from
+Campos Basin and suitable for the Namorado model.
+
+- CO2 density: determined by (Duan, 1992) based on pressure and temperature
+- Temperature: same as (Rockett, 2010)
+   
+    T(h) = Tref(h0) + (h-h0) x G, where 
+    
+        T: temperature
+        Tref: seabed temperature (~ 4 °C) => h0 = 0
+        G: Campos Basin geothermal gradient (~ 23.36 ºC / km) 
+        h: depth
+
+- Hydrostatic pressure: same as (Rockett, 2010)
+
+    p(h) = pref(h0) + (h-h0) x P, where
+
+        p: pressure 
+        pref: reference pressure 
+        P: hydrostatic pressure gradient (~ 100 bar/km = 10 MPa/km) 
+        h: depth
+        
+[R1]: Ciotta, M. Estudo De Possibilidades Para Armazenar CO2 em  Reservatórios Geológicos Offshore Na Bacia De Santos, 2019, University of
+São Paulo
+
+
+CO2 critical point
+------------------ 
+
+- Critical temperature: 31.0 °C (304.15 K)
+- Critical pressure: 7.38 MPa (or 73.8 bar)
+
+
+Others
+------
+
+1 atm = 0.101325 MPa (atmospheric pressure, if reference)
+1 bar = 10^5 Pa = 0.1 MPa ~ 0.987 atm
+
+%}
+
+t = tic;
+P_r = PARAMS.Fluid.pres_ref; % reference pressure [MPa]
+T_r = PARAMS.Fluid.temp_ref; % reference temperature [º C]
+
+%% Brine saturation
+
+%{
+
+---------------------------
+REFERENCE FOR BRINE DENSITY
+---------------------------
+
+Brine density is computed through interpolation between pure water (H20)
+and pure sodium chloride (NaCl) densities by using mass fractions:
+
+    \rho_w = \rho_{H20} X_{H20} + \rho_{NaCl,liquid} X_{NaCl,liquid}, where
+
+        \rho_i: phase density for phase i [kg/m3]
+           X_i: mass fraction for phase i [ ]
+
+
+Pure liquid NaCl density is obtained from correlations after (Dreisner, 2007)
+Eqs. (4) - (6):
+
+
+
+        \rho_{NaCl,liquid} = \frac{\rho_{NaCl,liquid}^0}{1 - 0.1 \log(1 + 10P
+        c_{NaCl,liquid})}, where 
+
+            P: pressure
+            \rho_{NaCl,liquid}^0}: reference density at 1 bar [kg/m3]
+            c_{NaCl,liquid}: compressibility [1/bar]
+
+It follows that:
+
+\rho_{NaCl,liquid}^0} = \frac{m_0}{m_1 + m_2T + m_3T^2}
+c_{NaCl,liquid} = m_4 + m_5T,
+
+where 
+    
+              T: temperature [C]
+            m_0: 58443
+            m_1: 23.772
+            m_2: 0.018639
+            m_3: -1.9687e-6
+            m_4: -1.5259e-5
+            m_5: 5.5058e-8
+
+
+
+(Driesner, 2007): DOI: 10.1016/j.gca.2007.05.026
+
+Furthermore, we assume that, for pure water, 1000 [kg/m3], and for 
+Campos Basin, X_{NaCl,liquid} may vary from 1% to 20% [0.01 to 0.20].
+
+
+Note: Driesner formula is originally replicated from 
+"Tödheide K. (1980) The influence of density and temperature on
+the properties of pure molten salts. Angew. Chem. Int. Ed. Engl.
+19, 606–619."
+
+
+-----------------------------
+REFERENCE FOR BRINE VISCOSITY
+-----------------------------
+
+To compute the brine viscosity, we use the (Mao & Duan, 2009) model and a
+few steps.
+
+Mao & Duan expounded: "the viscosity of aqueous electrolyte solutions depends 
+strongly on temperature, less on salinity, and is much less dependent
+on pressure."
+
+The following procedure depends only on the brine saturation:
+
+1. Given the brine density [kg/m3] and brine mass fraction (saturation)
+[%], compute the molality (m) [mol/kg] as:
+
+m = \frac{ 1000 X_{NaCl} }{ M_{NaCl} (1 - X_{NaCl})}
+
+where M_{\text{NaCl}} is the molar mass of NaCl (58.44 g/mol).
+
+
+2. Compute the water viscosity
+
+\log (\mu_{H20}) = \sum_{i=1}^5 d_i T^{i-3} + \sum_{i=6}^{10} d_i \rho_{H2O} T^{i-8}
+
+3. Compute the relative viscosity:
+
+\log (\mu_r) = Am + Bm^2 + Cm^3,  \mu_r = \frac{\mu_{brine}}{\mu_{H2O},
+
+where 
+
+A = a_0 + a_1T + a_2T^2
+B = b_0 + b_1T + b_2T^2
+C = c_0 + c_1T
+
+where:
+ 
+        T : temperature [K]
+        a0: -0.21319213
+        a1: 0.13651589e-2
+        a2: -0.12191756e-5
+        b0: 0.69161945e-1
+        b1: −0.27292263e-3
+        b2: 0.20852448e−6
+        c0: −0.25988855e−2
+        c1: 0.77989227e-5
+
+
+(Mao & Duan, 2009): DOI: 10.1007/s10765-009-0646-7
+
+
+
+%}
+
+gravity on; 
+g = gravity; 
+
+% mass fractions for H2O-NaCl binary mixture (brine)
+X_NaCl  = PARAMS.Fluid.XNaCl;
+rho_H2O = PARAMS.Fluid.rho_h2o; % water density [kg/m3]; reference: 1000
+t_ref   = T_r + 273.15; % reference temperature, in Kelvin
+
+% Brine density (Driesner) and viscosity (Mao & Duan) at the reference
+% conditions; precomputed for the whole sweep by py/fluid_properties.py
+% when available
+if isfield(PARAMS.Fluid, 'rhow') && isfield(PARAMS.Fluid, 'muw')
+    rhow = PARAMS.Fluid.rhow;
+    muw  = PARAMS.Fluid.muw;
+else
+    [rhow, muw] = brinePropsPUMLE(P_r, T_r, X_NaCl, rho_H2O);
+end
+
+
+% === Further parameters
+co2     = co2PropsPUMLE(); % sampled tables of co2 fluid properties (MRST), loaded once per session
+p_ref   = P_r * mega * Pascal; % reference pressure
+rhoc    = co2.rho(p_ref, t_ref); % co2 density at ref. press/temp
+cf_co2  = co2.rhoDP(p_ref, t_ref) / rhoc; % co2 compressibility
+cf_wat  = 0; % brine compressibility (zero)
+cf_rock = PARAMS.Fluid.cp_rock / barsa; % rock compressibility
+muco2   = co2.mu(p_ref, t_ref) * Pascal * second; % co2 viscosity
+
+mrstModule add ad-props; % The module where initSimpleADIFluid is found
+
+% Use function 'initSimpleADIFluid' to make a simple fluid object
+fluid = initSimpleADIFluid('phases', 'WG'           , ...
+                           'mu'  , [muw, muco2]     , ...
+                           'rho' , [rhow, rhoc]     , ...
+                           'pRef', p_ref            , ...
+                           'c'   , [cf_wat, cf_co2] , ... 
+                           'cR'  , cf_rock          , ...                           
+                           'n'   , [2 2]);
+
+% Optional pressure-dependent densities and CO2 viscosity, interpolated
+% from tables ([Fluid] pressure_tables)
+if isfield(PARAMS.Fluid, 'pressure_tables') && logical(PARAMS.Fluid.pressure_tables)
+    pmin = PARAMS.Fluid.table_pmin; pmax = PARAMS.Fluid.table_pmax;
+    if pmin <= 0, pmin = 0.5*P_r; end
+    if pmax <= 0, pmax = 2*P_r;   end
+    table_opts = struct('p_ref', p_ref, 'T', T_r, 'X_NaCl', X_NaCl, 'rho_H2O', rho_H2O, ...
+                        'rhoc', rhoc, 'pmin', pmin * mega * Pascal, ...
+                        'pmax', pmax * mega * Pascal, 'points', PARAMS.Fluid.table_points);
+    fluid = pressureTablesPUMLE(fluid, co2, table_opts);
+end
+
+% Change relperm curves
+srw = PARAMS.Fluid.srw;
+src = PARAMS.Fluid.src;
+fluid.krW = @(s) fluid.krW(max((s-srw)./(1-srw), 0));
+fluid.krG = @(s) fluid.krG(max((s-src)./(1-src), 0));
+
+% Add capillary pressure curve
+pe = PARAMS.Fluid.pe * kilo * Pascal;
+pcWG = @(sw) pe * sw.^(-1/2);
+fluid.pcWG = @(sg) pcWG(max((1-sg-srw)./(1-srw), 1e-5)); %@@
+metrics.stages.fluid_setup = toc(t);
+
+
+%% Initial state
+
+initState.pressure = rhow * g(3) * G.cells.centroids(:,3); % initial pressure
+initState.s = repmat([PARAMS.InitialConditions.sw_0, 1 - PARAMS.InitialConditions.sw_0],...
+    G.cells.num, 1); % initial saturations
+initState.sGmax = initState.s(:,2); % initial max. gas saturation (hysteresis)
+
+
+%% Boundary conditions
+
+% Start with an empty set of boundary faces
+bc = [];
+
+% identify all vertical faces
+vface_ind = (G.faces.normals(:,3) == 0);
+
+% identify all boundary faces (having only one cell neighbor
+bface_ind = (prod(G.faces.neighbors, 2) == 0);
+
+% identify all lateral boundary faces
+bc_face_ix = find(vface_ind & bface_ind);
+
+% identify cells neighbouring lateral boundary baces
+bc_cell_ix = sum(G.faces.neighbors(bc_face_ix,:), 2);
+
+% lateral boundary face pressure equals pressure of corresponding cell
+p_face_pressure = initState.pressure(bc_cell_ix); 
+
+% Add hydrostatic pressure conditions to open boundary faces
+bc = addBC(bc, bc_face_ix, PARAMS.BoundaryConditions.type, ...
+    p_face_pressure, 'sat', [1, 0]);
+
+
+%% Model
+
+t = tic;
+% Full 3D model (optionally coarsened), or the vertical-equilibrium model
+% on the top surface grid Gt for fast screening ([Pre-Processing]
+% model_type = 3d | ve). The model is built once; toModel converts the
+% fine-grid schedule of each well scenario to the model grid.
+model_type = '3d';
+if isfield(PARAMS.PreProcessing, 'model_type')
+    model_type = lower(PARAMS.PreProcessing.model_type);
+end
+
+switch model_type
+    case '3d'
+        model = TwoPhaseWaterGasModel(G, rock, fluid, 0, 0);
+        G_out = G;
+        toModel = @(schedule) schedule;
+
+        % Coarsened mid-fidelity run ([Grid] coarsen = ci, cj, ck)
+        coarsen = [1 1 1];
+        if isfield(PARAMS.Grid, 'coarsen'), coarsen = str2num(PARAMS.Grid.coarsen); end %#ok<ST2NM>
+        if any(coarsen > 1)
+            [model, initState, toModel] = coarsenModelPUMLE(model, initState, coarsen);
+            G_out = model.G;
+            model_type = 'coarse';
+        end
+    case 've'
+        fp = struct('muw', muw, 'muco2', muco2, 'rhow', rhow, 'rhoc', rhoc, ...
+                    'cf_wat', cf_wat, 'cf_co2', cf_co2, 'cf_rock', cf_rock, ...
+                    'p_ref', p_ref, 't_ref', t_ref, 'srw', srw, 'src', src, ...
+                    'sw_0', PARAMS.InitialConditions.sw_0);
+        [model, initState, toModel] = setupVEModelPUMLE(G, rock, Gt, fp);
+        G_out = Gt;
+    otherwise
+        error('Unknown model_type ''%s'' in [Pre-Processing].', model_type);
+end
+
+%% Solver
+
+% Nonlinear/linear solver settings ([Solver] section); CPR-preconditioned
+% iterative solver (AMGCL when available) instead of a direct solve
+solver_opts = struct();
+if isfield(PARAMS, 'Solver'), solver_opts = PARAMS.Solver; end
+[nls, model] = setupSolverPUMLE(model, solver_opts);
+
+% Timestep control: failed steps are cut (up to max_timestep_cuts times)
+% and the selector, if any (see Schedule), grows them back
+if isfield(PARAMS.Schedule, 'max_timestep_cuts')
+    nls.maxTimestepCuts = PARAMS.Schedule.max_timestep_cuts;
+end
+metrics.stages.model_setup = toc(t);
+
+%% Output settings
+
+% Output folder: the case scratch directory, when running a sweep
+if isfield(PARAMS.Paths, 'case_dir') && ~isempty(PARAMS.Paths.case_dir)
+    case_dir = PARAMS.Paths.case_dir;
+else
+    case_dir = fullfile(PARAMS.Paths.PUMLE_ROOT, PARAMS.Paths.PUMLE_RESULTS);
+end
+
+% Output settings ([Output] section); HDF5 field store by default, with
+% the plume summary; fields = false writes the summary only
+out_opts = struct('format', 'hdf5', 'compression', 1, 'summary', true, 'fields', true, ...
+                  'plume_threshold', 0.01);
+if isfield(PARAMS, 'Output')
+    for f = fieldnames(PARAMS.Output)', out_opts.(f{1}) = PARAMS.Output.(f{1}); end
+end
+out_opts.fidelity = model_type;
+out_opts.rhoGS    = model.fluid.rhoGS;
+
+%% Well scenarios
+
+% Wells of the case ([Wells] wells_list); the original UNISIM-I injector
+% NA1A perforated in layers 6-12 when none is given
+wells_list = 'NA1A: (38, 36, 6, 12)';
+if isfield(PARAMS.Wells, 'wells_list') && ~isempty(strtrim(PARAMS.Wells.wells_list))
+    wells_list = PARAMS.Wells.wells_list;
+end
+
+% Placement/rate sweep in this session ([Wells] scenarios, alternative
+% wells lists separated by '|'): the grid, fluid, model and solver above
+% are reused, and each scenario is written to <case_dir>/<case>_wNNN
+scenarios = {wells_list};
+if isfield(PARAMS.Wells, 'scenarios') && ~isempty(strtrim(PARAMS.Wells.scenarios))
+    scenarios = strtrim(strsplit(PARAMS.Wells.scenarios, '|'));
+end
+
+% Warm start ([Solver] warm_start): Newton starts each timestep from the
+% states of the nearest completed cases, chosen by PUMLE from the run
+% catalog; 3D and coarse models of single-scenario cases with a fixed
+% schedule only (an adaptive selector would change the timesteps)
+n_donors = 0;
+adaptive = isfield(PARAMS.Schedule, 'mode') && strcmpi(PARAMS.Schedule.mode, 'adaptive');
+if isfield(solver_opts, 'warm_start_files') && ~isempty(strtrim(solver_opts.warm_start_files)) ...
+        && numel(scenarios) == 1 && ~strcmp(model_type, 've') && ~adaptive
+    guess = warmStartGuessPUMLE(strtrim(strsplit(solver_opts.warm_start_files, ';')), ...
+                                str2num(solver_opts.warm_start_weights), G_out.cells.num); %#ok<ST2NM>
+    if ~isempty(guess)
+        model = WarmStartModelPUMLE(model, guess);
+        initState.warm_time = 0;
+        n_donors = numel(guess);
+    end
+end
+
+t_setup = t_shared + toc(t_case);
+metrics_setup = metrics;
+
+for sc = 1:numel(scenarios)
+
+t_scenario = tic;
+metrics = metrics_setup;
+
+if numel(scenarios) > 1
+    case_name = sprintf('%s_w%03d', PARAMS.PreProcessing.case_name, sc - 1);
+    out_dir   = fullfile(case_dir, case_name);
+    if ~exist(out_dir, 'dir'), mkdir(out_dir); end
+    fprintf('[MATLAB] Well scenario %d of %d: %s\n', sc, numel(scenarios), scenarios{sc});
+else
+    out_dir = case_dir;
+end
+
+
+%% Well placement
+
+% Injectors of the scenario, at the [Wells] CO2_inj rate [m^3/year] unless
+% given per well
+wells = parseWellsPUMLE(scenarios{sc}, PARAMS.Wells.CO2_inj);
+W = setupWellsPUMLE(G, rock, wells);
+
+%plotGrid(G, 'facecolor', 'none', 'edgealpha', 0.1);
+%plotGrid(G, vertcat(W.cells), 'facecolor', 'red');
+
+
+%% Schedule
+
+% Uniform, ramp-up or adaptive timesteps ([Schedule] mode), converted to
+% the model grid; the adaptive mode also returns the timestep selector of
+% the nonlinear solver
+[schedule, selector] = setupSchedulePUMLE(W, bc, PARAMS.Schedule);
+schedule = toModel(schedule);
+if ~isempty(selector), nls.timeStepSelector = selector; end
+
+% Plume summary of each timestep, over the wells of the scenario
+ctx = [];
+if logical(out_opts.summary)
+    ctx = summaryContextPUMLE(model, G, rock, Gt, trapSt, trap_volume, schedule, initState, src);
+    ctx.threshold = out_opts.plume_threshold;
+end
+csvname = fullfile(out_dir, strcat('summary_',case_name,'.csv'));
+
+
+%% Simulate
+
+if strcmpi(out_opts.format, 'json')
+
+    % all states are kept in memory and encoded at the end
+    t = tic;
+    [wellSol, states, sim_report] = simulateScheduleAD(initState, model, schedule, 'NonLinearSolver', nls);
+    metrics.stages.simulate = toc(t);
+
+    % JSON file name
+    fname = fullfile(out_dir, strcat('states_',case_name,'.json'));
+
+    % Encoding
+    t = tic;
+    if logical(out_opts.fields)
+        json = jsonencode(states);
+
+        % Write to file
+        fid = fopen(fname,'w'); fwrite(fid,json); fclose(fid);
+    end
+
+    if ~isempty(ctx)
+        rows = cellfun(@(state) plumeSummaryPUMLE(state, ctx), states, 'UniformOutput', false);
+        writeSummaryTablePUMLE(csvname, cumsum(schedule.step.val), [rows{:}]);
+    end
+    metrics.stages.output_write = toc(t);
+
+    % Status
+    fprintf('[MATLAB] Simulation data exported to JSON.\n')
+
+else
+
+    % HDF5 file name
+    fname = fullfile(out_dir, strcat('states_',case_name,'.h5'));
+
+    % restart an interrupted run from its last streamed timestep, when the
+    % sweep asks for it ([Output] restart, set per case by PUMLE)
+    t = tic;
+    if ~isempty(ctx)
+        out_opts.summary_fields = fieldnames(plumeSummaryPUMLE(initState, ctx));
+    end
+    step0 = 0;
+    if isfield(out_opts, 'restart') && logical(out_opts.restart)
+        [state0, step0] = resumeStorePUMLE(fname);
+        if step0 > 0 && n_donors > 0
+            state0.warm_time = sum(schedule.step.val(1:step0));
+        end
+    end
+
+    if step0 == 0
+        % active-cell float32 fields, one chunk per timestep
+        createStorePUMLE(fname, G_out, out_opts);
+        state0 = initState;
+    else
+        fprintf('[MATLAB] Restarting from timestep %d of %d.\n', step0, numel(schedule.step.val));
+    end
+
+    t_store = toc(t);
+
+    % remaining part of the schedule
+    t_end = cumsum(schedule.step.val);
+    remaining = schedule;
+    remaining.step.val     = schedule.step.val(step0+1:end);
+    remaining.step.control = schedule.step.control(step0+1:end);
+
+    % each converged timestep is streamed to the store as soon as it is 
+    % ready, so the states are not held in memory
+    codec   = fieldCodecPUMLE(out_opts, fname, step0, state0);
+    handler = StoreHandlerPUMLE(fname, t_end(step0+1:end), 'offset', step0, ...
+                                'summary', ctx, 'fields', logical(out_opts.fields), ...
+                                'codec', codec);
+    % only wellSol is requested (more outputs make simulateScheduleAD keep
+    % every state); the control step reports go to an in-memory handler
+    sim_report = [];
+    t = tic;
+    if ~isempty(remaining.step.val)
+        reports = ResultHandler('writeToDisk', false, 'storeInMemory', true);
+        wellSol = simulateScheduleAD(state0, model, remaining, ...
+                                     'OutputHandler', handler, ...
+                                     'ReportHandler', reports, ...
+                                     'NonLinearSolver', nls);
+        sim_report = struct('ControlstepReports', {arrayfun(@(i) reports{i}, ...
+                            (1:reports.numelData())', 'UniformOutput', false)});
+    end
+
+    % the streamed writes are part of the simulate stage
+    metrics.stages.simulate     = toc(t);
+
+    % compact summary table next to the store, including restarted steps
+    t = tic;
+    if ~isempty(ctx)
+        summary = struct();
+        for f = out_opts.summary_fields(:)'
+            summary.(f{1}) = h5read(fname, ['/summary/', f{1}]);
+        end
+        writeSummaryTablePUMLE(csvname, h5read(fname, '/time'), summary);
+    end
+    metrics.stages.output_write = t_store + handler.write_time + toc(t);
+    metrics.restart_step        = step0;
+
+    % Status
+    fprintf('[MATLAB] Simulation data exported to HDF5.\n')
+
+end
+
+%% Metrics
+
+% Stage timings, solver statistics, peak memory and output size, written
+% next to the case outputs; PUMLE merges them into metrics.json. The setup
+% stages before the well scenarios are shared by all of them.
+metrics.case_name      = case_name;
+metrics.fidelity       = model_type;
+metrics.cells          = G_out.cells.num;
+metrics.wells          = scenarios{sc};
+metrics.scenarios      = numel(scenarios);
+metrics.warm_start     = n_donors;
+metrics.solver         = solverStatsPUMLE(sim_report);
+metrics.peak_memory_mb = peakMemoryPUMLE();
+out_file = dir(fname);
+metrics.bytes_written  = sum([out_file.bytes]);
+metrics.stages.total   = t_setup + toc(t_scenario);
+
+fid = fopen(fullfile(out_dir, 'matlab_metrics.json'), 'w');
+fwrite(fid, jsonencode(metrics)); fclose(fid);
+
+end
+
+end
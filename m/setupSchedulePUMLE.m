@@ -0,0 +1,72 @@
+function [schedule, selector] = setupSchedulePUMLE(W, bc, opts)
+%% setupSchedulePUMLE
+%
+% Builds the injection/migration schedule from the [Schedule] section of
+% PUMLE's setup. Control 1 injects with the wells W, control 2 shuts them
+% (zero rate); both use the boundary conditions bc.
+%
+%   opts.mode: 'uniform'  - injection_time/injection_timesteps and
+%                           migration_time/migration_timesteps steps
+%              'rampup'   - as 'uniform', with the injection steps
+%                           preceded by rampup_steps geometrically growing
+%                           steps (rampupTimesteps)
+%              'adaptive' - as 'rampup', plus a timestep selector that
+%                           adjusts the ministeps inside each control step
+%                           from the Newton iteration count
+%                           (selector = 'iterations', target_iterations)
+%                           or the saturation change (selector =
+%                           'saturation', target_ds). Failed steps are cut
+%                           and the selector grows them back afterwards.
+%
+% Returns the schedule and the selector to set on the NonLinearSolver
+% (empty unless mode is 'adaptive').
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+defaults = struct('mode', 'uniform', 'rampup_steps', 5, 'selector', 'iterations', ...
+                  'target_iterations', 5, 'target_ds', 0.2);
+for f = fieldnames(opts)', defaults.(f{1}) = opts.(f{1}); end
+opts = defaults;
+
+% Setting up two copies of the well and boundary specifications.
+% Modifying the well in the second copy to have a zero flow rate.
+schedule.control    = struct('W', W, 'bc', bc);
+schedule.control(2) = struct('W', W, 'bc', bc);
+for i = 1:numel(schedule.control(2).W), schedule.control(2).W(i).val = 0; end
+
+t_injection = opts.injection_time * year;
+t_migration = opts.migration_time * year;
+
+dT_injection = t_injection / opts.injection_timesteps;
+dT_migration = t_migration / opts.migration_timesteps;
+
+mode = lower(opts.mode);
+switch mode
+    case 'uniform'
+        vec_injection = repmat(dT_injection, opts.injection_timesteps, 1);
+    case {'rampup', 'adaptive'}
+        % injection with increasing timestep size up to dT_injection
+        vec_injection = rampupTimesteps(t_injection, dT_injection, opts.rampup_steps);
+    otherwise
+        error('Unknown schedule mode ''%s'' in [Schedule].', opts.mode);
+end
+vec_migration = repmat(dT_migration, opts.migration_timesteps, 1);
+
+schedule.step.val     = [vec_injection; vec_migration];
+schedule.step.control = [ones(numel(vec_injection), 1); 2*ones(numel(vec_migration), 1)];
+
+selector = [];
+if strcmp(mode, 'adaptive')
+    switch lower(opts.selector)
+        case 'iterations'
+            selector = IterationCountTimeStepSelector('targetIterationCount', opts.target_iterations);
+        case 'saturation'
+            selector = StateChangeTimeStepSelector('targetProps', {'s'}, ...
+                                                   'targetChangeAbs', opts.target_ds);
+        otherwise
+            error('Unknown timestep selector ''%s'' in [Schedule].', opts.selector);
+    end
+end
+
+end
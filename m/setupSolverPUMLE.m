@@ -0,0 +1,69 @@
+function [nls, model] = setupSolverPUMLE(model, opts)
+%% setupSolverPUMLE
+%
+% Builds the nonlinear and linear solvers of the simulation from the
+% [Solver] section of PUMLE's setup:
+%
+%   opts.linear_solver         : 'cpr' (CPR-preconditioned iterative solver)
+%                                or 'direct' (MRST's default backslash)
+%   opts.amgcl                 : use AMGCL_CPRSolverAD when the AMGCL mex
+%                                is available, CPRSolverAD otherwise
+%   opts.linear_tolerance      : relative tolerance of the linear solver
+%   opts.linear_max_iterations : maximum linear iterations
+%   opts.tolerance_cnv         : model CNV (cell-wise) tolerance
+%   opts.tolerance_mb          : model material balance tolerance
+%   opts.max_iterations        : maximum Newton iterations per step
+%   opts.threads               : computational threads, 0 for MATLAB's
+%                                default
+%
+% Returns the NonLinearSolver to pass to simulateScheduleAD and the model
+% with the tolerances set.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+defaults = struct('linear_solver', 'cpr', 'amgcl', true, ...
+                  'linear_tolerance', 1e-4, 'linear_max_iterations', 100, ...
+                  'tolerance_cnv', 1e-3, 'tolerance_mb', 1e-7, ...
+                  'max_iterations', 25, 'threads', 0);
+for f = fieldnames(opts)', defaults.(f{1}) = opts.(f{1}); end
+opts = defaults;
+
+% Threads (BLAS/direct solves and AMGCL's OpenMP backend)
+if opts.threads > 0
+    maxNumCompThreads(opts.threads);
+    setenv('OMP_NUM_THREADS', num2str(opts.threads));
+end
+
+% Model tolerances
+model.toleranceCNV = opts.tolerance_cnv;
+model.toleranceMB  = opts.tolerance_mb;
+
+% Linear solver
+switch lower(opts.linear_solver)
+    case 'cpr'
+        lsolve = [];
+        if logical(opts.amgcl)
+            mrstModule add linearsolvers;
+            if exist('amgcl_matlab', 'file') == 3
+                lsolve = AMGCL_CPRSolverAD('tolerance', opts.linear_tolerance, ...
+                                           'maxIterations', opts.linear_max_iterations);
+            else
+                fprintf('[MATLAB] AMGCL not available, using CPRSolverAD.\n')
+            end
+        end
+        if isempty(lsolve)
+            lsolve = CPRSolverAD('tolerance', opts.linear_tolerance, ...
+                                 'maxIterations', opts.linear_max_iterations);
+        end
+    case 'direct'
+        lsolve = BackslashSolverAD();
+    otherwise
+        error('Unknown linear solver ''%s'' in [Solver].', opts.linear_solver);
+end
+
+nls = NonLinearSolver('LinearSolver', lsolve, 'maxIterations', opts.max_iterations);
+
+fprintf('[MATLAB] Linear solver: %s.\n', class(lsolve))
+
+end
@@ -0,0 +1,64 @@
+function [model, initState, toModel] = setupVEModelPUMLE(G, rock, Gt, fp)
+%% setupVEModelPUMLE
+%
+% Vertical-equilibrium (VE) counterpart of the 3D TwoPhaseWaterGasModel
+% set up in co2lab3DPUMLE, following co2lab-ve's synthetic3DExample: the
+% simulation runs on the top-surface grid Gt with CO2VEBlackOilTypeModel,
+% the same fluid properties, and the wells and boundary conditions of the
+% 3D schedules converted to Gt.
+%
+%   fp: fluid properties computed by co2lab3DPUMLE, with fields
+%       muw, muco2, rhow, rhoc, cf_wat, cf_co2, cf_rock, p_ref, t_ref,
+%       srw, src and sw_0 (initial brine saturation)
+%
+% Returns the VE model, the hydrostatic initial state on Gt and the
+% function toModel that converts a 3D schedule to Gt, so that schedules
+% of several well scenarios run on the same model.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+mrstModule add co2lab-ve;
+
+g = norm(gravity);
+
+% Vertically averaged rock properties
+rock2D = averageRock(rock, Gt);
+
+% Sharp-interface VE fluid with the properties of the 3D fluid
+fluid = makeVEFluid(Gt, rock2D, 'sharp_interface_simple', ...
+                    'fixedT'      , fp.t_ref              , ...
+                    'wat_mu_ref'  , fp.muw                , ...
+                    'co2_mu_ref'  , fp.muco2              , ...
+                    'wat_rho_ref' , fp.rhow               , ...
+                    'co2_rho_ref' , fp.rhoc               , ...
+                    'wat_rho_pvt' , [fp.cf_wat, fp.p_ref] , ...
+                    'co2_rho_pvt' , [fp.cf_co2, fp.p_ref] , ...
+                    'residual'    , [fp.srw, fp.src]      , ...
+                    'dissolution' , false                 , ...
+                    'pvMult_p_ref', fp.p_ref              , ...
+                    'pvMult_fac'  , fp.cf_rock);
+
+model = CO2VEBlackOilTypeModel(Gt, rock2D, fluid);
+
+% Initial state
+initState.pressure = fp.rhow * g * Gt.cells.z;
+initState.s        = repmat([fp.sw_0, 1 - fp.sw_0], Gt.cells.num, 1);
+initState.sGmax    = initState.s(:,2);
+
+% Hydrostatic pressure on the boundary faces of the top surface
+bc_face_ix = find(any(Gt.faces.neighbors == 0, 2));
+bc2D = addBC([], bc_face_ix, 'pressure', Gt.faces.z(bc_face_ix) * fp.rhow * g, ...
+             'sat', [1 0]);
+
+toModel = @(schedule) convertScheduleVE(schedule, G, Gt, rock2D, bc2D);
+
+end
+
+function schedule = convertScheduleVE(schedule, G, Gt, rock2D, bc2D)
+% Same controls, with wells and boundary conditions on Gt
+for i = 1:numel(schedule.control)
+    schedule.control(i).W  = convertwellsVE(schedule.control(i).W, G, Gt, rock2D);
+    schedule.control(i).bc = bc2D;
+end
+end
@@ -0,0 +1,40 @@
+function W = setupWellsPUMLE(G, rock, wells)
+%% setupWellsPUMLE
+%
+% Adds one rate-controlled CO2 injector per entry of wells (see
+% parseWellsPUMLE), perforated in the active cells of column (I, J) within
+% its layer range. The cartesian coordinates of all perforations of a well
+% are mapped to cell indices of G at once.
+%
+% Returns the well structure W.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+% reverse mapping: cartesian index -> active cell (0 if inactive)
+Ind = zeros(prod(G.cartDims), 1);
+Ind(G.cells.indexMap) = 1:G.cells.num;
+
+W = [];
+for i = 1:numel(wells)
+    w = wells(i);
+    if any(w.ij < 1) || any(w.ij > G.cartDims(1:2)) || w.layers(1) < 1 || w.layers(end) > G.cartDims(3)
+        error('Well ''%s'' lies outside the %d x %d x %d grid.', w.name, G.cartDims);
+    end
+
+    k = w.layers(:);
+    cells = Ind(sub2ind(G.cartDims, repmat(w.ij(1), numel(k), 1), repmat(w.ij(2), numel(k), 1), k));
+    cells = cells(cells > 0);
+    if isempty(cells)
+        error('Well ''%s'' has no active cell in layers %d-%d.', w.name, w.layers([1 end]));
+    end
+
+    W = addWell(W, G, rock, cells, ...
+                'name', w.name, ...
+                'refDepth', G.cells.centroids(cells(1), 3), ... % BHP reference depth (top perforation)
+                'type', 'rate', ...                 % inject at constant rate
+                'val', w.rate * meter^3 / year, ... % volumetric injection rate
+                'comp_i', [0 1]);                   % inject CO2, not water
+end
+
+end
@@ -0,0 +1,40 @@
+function stats = solverStatsPUMLE(report)
+%% solverStatsPUMLE
+%
+% Summarizes the report returned by simulateScheduleAD: number of control
+% steps and ministeps, nonlinear and linear iterations, timestep cuts
+% (ministeps that did not converge and were cut) and the iterations spent
+% in them.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+stats = struct('control_steps', 0, 'ministeps', 0, 'nonlinear_iterations', 0, ...
+               'linear_iterations', 0, 'timestep_cuts', 0, 'wasted_iterations', 0);
+
+if isempty(report) || ~isfield(report, 'ControlstepReports'), return; end
+
+for i = 1:numel(report.ControlstepReports)
+    crep = report.ControlstepReports{i};
+    if isempty(crep), continue; end
+    stats.control_steps = stats.control_steps + 1;
+
+    for j = 1:numel(crep.StepReports)
+        srep = crep.StepReports{j};
+        stats.ministeps = stats.ministeps + 1;
+        stats.nonlinear_iterations = stats.nonlinear_iterations + srep.Iterations;
+        if ~srep.Converged
+            stats.timestep_cuts = stats.timestep_cuts + 1;
+            stats.wasted_iterations = stats.wasted_iterations + srep.Iterations;
+        end
+
+        for k = 1:numel(srep.NonlinearReport)
+            nrep = srep.NonlinearReport{k};
+            if isfield(nrep, 'LinearSolver') && isfield(nrep.LinearSolver, 'Iterations')
+                stats.linear_iterations = stats.linear_iterations + nrep.LinearSolver.Iterations;
+            end
+        end
+    end
+end
+
+end
@@ -0,0 +1,71 @@
+function ctx = summaryContextPUMLE(model, G, rock, Gt, trapSt, trap_volume, schedule, initState, src)
+%% summaryContextPUMLE
+%
+% Precomputes what plumeSummaryPUMLE needs to summarise a state of the
+% model: per fine cell (top surface column for VE models), the model cell,
+% Gt column, column area, centroid, pore volume and whether it lies in a
+% structural trap above its spill point (trapSt); the cells of the wells
+% and boundary conditions of the schedule; the initial pressure; and the
+% CO2 density function of the fluid.
+%
+%   schedule: schedule on the model grid (wells and bc of control 1)
+%   src:      residual CO2 saturation
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+isVE = isfield(model.G, 'columns');
+
+if isVE
+    % the model cells are the columns of the top surface grid
+    n          = Gt.cells.num;
+    ctx.map    = (1:n)';
+    ctx.col    = (1:n)';
+    ctx.xy     = Gt.cells.centroids(:, 1:2);
+    ctx.pv     = model.operators.pv;
+    bulk       = Gt.cells.volumes .* Gt.cells.H;
+    trapped    = trapSt.traps > 0;
+else
+    % fine cells, mapped to the blocks of coarse models
+    n       = G.cells.num;
+    ctx.map = (1:n)';
+    if isfield(model.G, 'partition'), ctx.map = model.G.partition(:); end
+
+    ctx.col = zeros(n, 1);
+    ctx.col(Gt.columns.cells) = rldecode((1:Gt.cells.num)', diff(Gt.cells.columnPos));
+    ctx.xy  = G.cells.centroids(:, 1:2);
+    ctx.pv  = rock.poro .* G.cells.volumes;
+    if isfield(rock, 'ntg'), ctx.pv = ctx.pv .* rock.ntg; end
+    bulk    = G.cells.volumes;
+
+    % structurally trapped: in a trap column, above the spill point
+    trap    = zeros(n, 1);
+    inCol   = ctx.col > 0;
+    trap(inCol) = trapSt.traps(ctx.col(inCol));
+    trapped = trap > 0;
+    trapped(trapped) = G.cells.centroids(trapped, 3) <= trapSt.trap_z(trap(trapped));
+end
+
+ctx.area    = Gt.cells.volumes;   % column areas of the top surface grid
+ctx.trapped = trapped;
+
+% pore volume of the traps, from their bulk volume (trap_volume) and the
+% mean porosity of the trapped cells
+ctx.trap_capacity = 0;
+if any(trapped)
+    ctx.trap_capacity = sum(trap_volume) * sum(ctx.pv(trapped)) / sum(bulk(trapped));
+end
+
+% pressure buildup at the wells and the boundary, over model cells
+W  = schedule.control(1).W;
+bc = schedule.control(1).bc;
+ctx.well_cells = vertcat(W.cells);
+ctx.bc_cells   = [];
+if ~isempty(bc), ctx.bc_cells = sum(model.G.faces.neighbors(bc.face, :), 2); end
+ctx.p0  = initState.pressure;
+ctx.src = src;
+
+fluid = model.fluid;
+ctx.rhoG = @(p) fluid.bG(p) .* fluid.rhoGS;
+
+end
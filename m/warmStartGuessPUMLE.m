@@ -0,0 +1,49 @@
+function guess = warmStartGuessPUMLE(files, weights, n_cells)
+%% warmStartGuessPUMLE
+%
+% Loads the pressure and gas saturation of every timestep of the HDF5
+% stores of the donor cases of a warm start (chosen by PUMLE from the run
+% catalog, [Solver] warm_start), for WarmStartModelPUMLE:
+%
+%   files   : cell array of donor stores
+%   weights : interpolation weight of each donor
+%   n_cells : number of cells of the model grid
+%
+% Donors that are missing or on another grid are skipped and the weights
+% of the others renormalized. Fields are kept in single precision. Returns
+% a struct array (time, pressure, sg, weight), empty if no donor is usable.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+guess = struct('time', {}, 'pressure', {}, 'sg', {}, 'weight', {});
+for d = 1:numel(files)
+    fname = files{d};
+    try
+        info = h5info(fname, '/pressure');
+        if info.Dataspace.Size(1) ~= n_cells
+            fprintf('[MATLAB] Warm start: ''%s'' is on another grid, skipped.\n', fname)
+            continue
+        end
+        time = h5read(fname, '/time');
+        T = numel(time);
+        sg = zeros(n_cells, T, 'single');
+        for k = 1:T
+            sg(:, k) = single(readFieldPUMLE(fname, 'sG', k));
+        end
+        guess(end+1) = struct('time', double(time(:))', ...
+                              'pressure', single(h5read(fname, '/pressure', [1 1], [n_cells T])), ...
+                              'sg', sg, 'weight', weights(d)); %#ok<AGROW>
+    catch err
+        fprintf('[MATLAB] Warm start: ''%s'' not read (%s).\n', fname, err.message)
+    end
+end
+
+if ~isempty(guess)
+    w = [guess.weight];
+    w = w / sum(w);
+    for d = 1:numel(guess), guess(d).weight = w(d); end
+    fprintf('[MATLAB] Warm start from %d case(s).\n', numel(guess))
+end
+
+end
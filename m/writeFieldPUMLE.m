@@ -0,0 +1,44 @@
+function c = writeFieldPUMLE(fname, name, v, step, c)
+%% writeFieldPUMLE
+%
+% Writes timestep step of the saturation field name to the HDF5 field
+% store with the encoding c (see fieldCodecPUMLE) and returns the updated
+% encoder state.
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+n = numel(v);
+path = ['/', name];
+
+switch c.kind
+    case 'float32'
+        h5write(fname, path, single(v(:)), [1 step], [n 1]);
+
+    case 'quant16'
+        h5write(fname, path, uint16(quantize16PUMLE(v)), [1 step], [n 1]);
+
+    case 'quant16-delta'
+        q = quantize16PUMLE(v);
+        d = q;
+        if mod(step - 1, c.keyframe) ~= 0, d = q - c.prev; end
+        h5write(fname, path, d, [1 step], [n 1]);
+        c.prev = q;
+
+    case {'sparse', 'sparse-quant16'}
+        idx = find(v(:) > c.eps);
+        if strcmp(c.kind, 'sparse-quant16')
+            vals = uint16(quantize16PUMLE(v(idx)));
+        else
+            vals = single(v(idx));
+        end
+        k = numel(idx);
+        if k > 0
+            h5write(fname, [path, '/index'],  int32(idx'), [1 c.next+1], [1 k]);
+            h5write(fname, [path, '/values'], vals(:)',    [1 c.next+1], [1 k]);
+        end
+        h5write(fname, [path, '/ptr'], int64([c.next; k]), [1 step], [2 1]);
+        c.next = c.next + k;
+end
+
+end
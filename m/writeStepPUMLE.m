@@ -0,0 +1,47 @@
+function codec = writeStepPUMLE(fname, step, state, t, summary, write_fields, codec)
+%% writeStepPUMLE
+%
+% Appends one timestep of a simulation state to the HDF5 field store
+% created by createStorePUMLE, and overwrites the restart checkpoint with
+% the full-precision state. The checkpoint step is updated last, so it
+% always points to a complete timestep.
+%
+%   fname: store file
+%    step: timestep index (1-based)
+%   state: MRST state with fields pressure, s = [sW, sG] and sGmax
+%       t: simulated time at the end of the step [s]
+% summary: plume summary of the state (plumeSummaryPUMLE), or [] for none
+% write_fields: write the fields (default true); the checkpoint is
+%               always written
+%   codec: encoding of the saturations (fieldCodecPUMLE), float32 by
+%          default; returned with the updated encoder state
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+if nargin < 5, summary = []; end
+if nargin < 6, write_fields = true; end
+if nargin < 7, codec = fieldCodecPUMLE(struct()); end
+
+n = numel(state.pressure);
+
+if write_fields
+    h5write(fname, '/pressure', single(state.pressure), [1 step], [n 1]);
+    codec.sW    = writeFieldPUMLE(fname, 'sW',    state.s(:,1), step, codec.sW);
+    codec.sG    = writeFieldPUMLE(fname, 'sG',    state.s(:,2), step, codec.sG);
+    codec.sGmax = writeFieldPUMLE(fname, 'sGmax', state.sGmax,  step, codec.sGmax);
+end
+h5write(fname, '/time', t, [1 step], [1 1]);
+
+if ~isempty(summary)
+    for f = fieldnames(summary)'
+        h5write(fname, ['/summary/', f{1}], summary.(f{1}), [1 step], [1 1]);
+    end
+end
+
+h5write(fname, '/checkpoint/pressure', state.pressure);
+h5write(fname, '/checkpoint/s',        state.s);
+h5write(fname, '/checkpoint/sGmax',    state.sGmax);
+h5writeatt(fname, '/checkpoint', 'step', int32(step));
+
+end
@@ -0,0 +1,28 @@
+function writeSummaryTablePUMLE(csvname, time, summary)
+%% writeSummaryTablePUMLE
+%
+% Writes the plume summary of a run as a CSV table with one row per
+% timestep: the simulated time [s] followed by the series of
+% plumeSummaryPUMLE.
+%
+%   time:    simulated time of each timestep [s]
+%   summary: struct with one vector per series, or the struct array of
+%            the per-step summaries
+%
+% Adaption made by Gustavo Oliveira
+% TRIL Lab | CI-UFPB | Brazil
+
+names = fieldnames(summary);
+if numel(summary) > 1
+    cols = struct();
+    for i = 1:numel(names), cols.(names{i}) = [summary.(names{i})]; end
+    summary = cols;
+end
+
+T = table(time(:), 'VariableNames', {'time'});
+for i = 1:numel(names)
+    T.(names{i}) = summary.(names{i})(:);
+end
+writetable(T, csvname);
+
+end
@@ -0,0 +1,267 @@
+import os
+import csv
+import math
+import pickle
+import logging
+import numpy as np
+
+from scipy.stats import qmc
+from sklearn.gaussian_process import GaussianProcessRegressor
+from sklearn.gaussian_process.kernels import ConstantKernel, Matern, WhiteKernel
+from typing import Dict, List, Optional, Tuple
+
+from dataset_store import ShardedStore
+from field_store import FieldStore
+from sweep_design import SweepDesign
+from sweep_journal import UNHASHED_KEYS, UNHASHED_SECTIONS
+from warm_start import DERIVED_PARAMS
+
+
+def case_targets(source: str, metrics: List[str]) -> Optional[np.ndarray]:
+    """
+    Targets of one case from the plume summary of its HDF5 store: the
+    maximum over time of the metrics named 'max_*', the final value of the
+    others (e.g. 'co2_mass', 'footprint_area'). None if the store or any
+    metric is missing.
+    """
+    if not source.endswith('.h5') or not os.path.isfile(source):
+        return None
+    with FieldStore(source) as store:
+        summary = store.summary()
+    if not all(m in summary and summary[m].size for m in metrics):
+        return None
+    return np.array([summary[m].max() if m.startswith('max_') else summary[m][-1] for m in metrics])
+
+
+def _same_value(a: object, b: object) -> bool:
+    try:
+        return math.isclose(float(a), float(b), rel_tol=1e-9)
+    except (TypeError, ValueError):
+        return str(a).strip() == str(b).strip()
+
+
+class ActiveLearningSweep:
+    def __init__(self, gen, params: Dict) -> None:
+        """Surrogate-guided sweep over the ranges of `[Sweep]` (`[Active Learning]`).
+
+        Rounds alternate between running a batch of cases and fitting a
+        Gaussian process per plume summary metric (`metrics`) on all cases
+        run so far. The next batch is drawn from a Latin hypercube of
+        `candidates` points where the surrogate is most uncertain (sum of the
+        standardized predictive deviations), one point at a time with the
+        pending points added at their predicted mean (kriging believer), so
+        that a batch spreads over the uncertain regions instead of piling up
+        on one.
+
+        The accuracy of a round is measured on the batch that follows it,
+        before those cases are used for training: per metric, the RMSE of
+        the predictions over the standard deviation of the metric. The sweep
+        stops when every metric is below `target_error`, or after
+        `max_cases` cases.
+
+        Batches run with `GenerateDataset.run_cases`, so they use the
+        configured execution backend, the journal and the dataset store.
+        Cases of the store (`[Execution] store_dir`) that vary the same
+        parameters and did not fail the quality checks are used for
+        training from the first round.
+
+        Parameters
+        ----------
+        gen : GenerateDataset
+            Dataset generator running the cases.
+        params : Dict
+            Simulation parameters, including the 'Sweep' ranges and the
+            'Active Learning' section.
+        """
+        self.gen = gen
+        self.params = params
+        self.logger = logging.getLogger("PUMLELogger")
+
+        options = params.get('Active Learning', {})
+        self.initial_samples = int(options.get('initial_samples', 8))
+        self.batch_size = int(options.get('batch_size', 4))
+        self.max_cases = int(options.get('max_cases', 64))
+        self.target_error = float(options.get('target_error', 0.05))
+        self.n_candidates = int(options.get('candidates', 2048))
+        self.metrics = [m.strip() for m in str(options.get('metrics', 'co2_mass')).split(',') if m.strip()]
+
+        self.design = SweepDesign(params)
+        if not self.design.ranges:
+            self.logger.error("Active learning needs at least one parameter range in [Sweep].")
+            raise ValueError("No parameter range declared in [Sweep].")
+        self.seed = self.design.seed
+        self.lo, self.hi = self.design.bounds
+        self.res_dir = os.path.join(params['Paths']['PUMLE_ROOT'], params['Paths']['PUMLE_RESULTS'])
+        self.models: List[GaussianProcessRegressor] = []
+        self._train: Optional[Tuple[np.ndarray, np.ndarray]] = None
+
+    def _unit(self, points: np.ndarray) -> np.ndarray:
+        return (points - self.lo) / np.where(self.hi > self.lo, self.hi - self.lo, 1.0)
+
+    def _lhs(self, n: int, seed: int) -> np.ndarray:
+        unit = qmc.LatinHypercube(d=len(self.lo), seed=seed).random(n)
+        return self.lo + unit * (self.hi - self.lo)
+
+    def _point(self, case: Dict) -> np.ndarray:
+        return np.array([case[section][key] for section, key, _, _ in self.design.ranges], dtype=np.float64)
+
+    def _store_data(self) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Training data from the cases already in the dataset store: those of
+        the fidelity of the sweep whose parameters outside the swept ranges
+        (deck, schedule, wells, ...) are the ones of this setup.
+        """
+        store_dir = self.params.get('Execution', {}).get('store_dir', '')
+        d = len(self.design.ranges)
+        if not store_dir:
+            return np.empty((0, d)), np.empty((0, len(self.metrics)))
+
+        store = ShardedStore(store_dir)
+        failed = {name for name, r in store.qa().items() if r['status'] == 'failed'}
+        names = [f"{section}.{key}" for section, key, _, _ in self.design.ranges]
+        ignored = set(names) | set(DERIVED_PARAMS) | {'Pre-Processing.case_name'}
+        setup = {f"{section}.{key}": value for section, content in self.params.items()
+                 if isinstance(content, dict) and section not in UNHASHED_SECTIONS + ('Sweep',)
+                 for key, value in content.items() if key not in UNHASHED_KEYS.get(section, ())}
+        setup = {k: v for k, v in setup.items() if k not in ignored}
+        fidelity = ShardedStore.case_fidelity(setup)
+        X, Y = [], []
+        for name, record in store.manifest().items():
+            params = record.get('params', {})
+            if name in failed or record.get('fidelity', '3d') != fidelity \
+                    or not all(isinstance(params.get(n), float) for n in names) \
+                    or not all(_same_value(params[k], v) for k, v in setup.items() if k in params):
+                continue
+            y = case_targets(record.get('source', ''), self.metrics)
+            if y is not None:
+                X.append([params[n] for n in names])
+                Y.append(y)
+        self.logger.info(f"Active learning: {len(X)} case(s) of the dataset store used for training.")
+        return np.array(X).reshape(-1, d), np.array(Y).reshape(-1, len(self.metrics))
+
+    def _run(self, points: np.ndarray, tag: str) -> Tuple[np.ndarray, np.ndarray, List[Dict], Dict[str, str]]:
+        """Run one batch; returns the points and targets of its successful cases, the cases and their statuses."""
+        cases = self.design.cases(points, tag=tag)
+        statuses = self.gen.run_cases(cases)
+        X, Y = [], []
+        for case in cases:
+            name = case['Pre-Processing']['case_name']
+            y = case_targets(self.gen._output_file(case), self.metrics) if statuses[name] == 'done' else None
+            if y is None:
+                self.logger.warning(f"Case '{name}' has no summary metrics {self.metrics}; not used for training.")
+                continue
+            X.append(self._point(case))
+            Y.append(y)
+        return np.array(X).reshape(-1, len(self.lo)), np.array(Y).reshape(-1, len(self.metrics)), cases, statuses
+
+    def fit(self, X: np.ndarray, Y: np.ndarray) -> None:
+        """Fit one Gaussian process per metric on standardized targets."""
+        kernel = ConstantKernel(1.0) * Matern(length_scale=np.full(X.shape[1], 0.3),
+                                              length_scale_bounds=(1e-2, 1e2), nu=2.5) \
+            + WhiteKernel(1e-4, noise_level_bounds=(1e-8, 1e-1))
+        self.models = []
+        self._train = (self._unit(X), Y)
+        for j in range(Y.shape[1]):
+            gp = GaussianProcessRegressor(kernel, normalize_y=True, n_restarts_optimizer=2,
+                                          random_state=self.seed)
+            self.models.append(gp.fit(self._unit(X), Y[:, j]))
+
+    def predict(self, points: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+        """Predicted mean and standard deviation of each metric, shape (n_points, n_metrics)."""
+        unit = self._unit(np.atleast_2d(points))
+        out = [gp.predict(unit, return_std=True) for gp in self.models]
+        return np.stack([m for m, _ in out], axis=1), np.stack([s for _, s in out], axis=1)
+
+    def error(self, X: np.ndarray, Y: np.ndarray, Y_all: np.ndarray) -> np.ndarray:
+        """RMSE of the predictions of each metric over its standard deviation in `Y_all`."""
+        mean, _ = self.predict(X)
+        scale = np.where(Y_all.std(axis=0) > 0, Y_all.std(axis=0), 1.0)
+        return np.sqrt(np.mean((mean - Y) ** 2, axis=0)) / scale
+
+    def select(self, n: int, seed: int) -> np.ndarray:
+        """Next batch: the most uncertain candidates, with pending points believed at their mean."""
+        candidates = self._unit(self._lhs(self.n_candidates, seed))
+        models = list(self.models)
+        X_train, Y_train = self._train
+        X = [X_train] * len(models)
+        y = [Y_train[:, j] for j in range(len(models))]
+        scale = np.where(Y_train.std(axis=0) > 0, Y_train.std(axis=0), 1.0)
+
+        chosen = []
+        for _ in range(min(n, len(candidates))):
+            score = sum(gp.predict(candidates, return_std=True)[1] / scale[j] for j, gp in enumerate(models))
+            best = int(np.argmax(score))
+            chosen.append(candidates[best])
+            for j, gp in enumerate(models):
+                X[j] = np.vstack([X[j], candidates[best]])
+                y[j] = np.append(y[j], gp.predict(candidates[best:best + 1]))
+                # refit with the kernel of the last round, hyperparameters fixed
+                models[j] = GaussianProcessRegressor(gp.kernel_, normalize_y=True,
+                                                     optimizer=None).fit(X[j], y[j])
+            candidates = np.delete(candidates, best, axis=0)
+        return self.lo + np.array(chosen) * (self.hi - self.lo)
+
+    def _log_round(self, rows: List[Dict]) -> None:
+        out = os.path.join(self.res_dir, 'active_learning.csv')
+        with open(out, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0]))
+            writer.writeheader()
+            writer.writerows(rows)
+
+    def run(self) -> Dict[str, str]:
+        """
+        Run the active-learning sweep.
+
+        The round history (cases, training size and error per metric) is
+        saved as `active_learning.csv`, the case table of all rounds as
+        `case_table.csv` and the last surrogate as `surrogate.pkl`, in the
+        results folder.
+
+        Returns
+        -------
+        Dict[str, str]
+            Status ('done' or 'failed') of each case, keyed by case name.
+        """
+        os.makedirs(self.res_dir, exist_ok=True)
+        X, Y = self._store_data()
+        rng = np.random.default_rng(self.seed)
+
+        n_initial = self.initial_samples - len(X)
+        points = self._lhs(n_initial, int(rng.integers(2**31))) if n_initial > 0 else None
+        statuses, all_cases, rows = {}, [], []
+        n_run = 0
+        for round_ in range(self.max_cases):
+            if n_run >= self.max_cases:
+                self.logger.info(f"Active learning stopped after {n_run} case(s) (max_cases = {self.max_cases}).")
+                break
+            if points is None:
+                if len(X) < 2:
+                    self.logger.error("Active learning needs at least 2 successful cases to fit the surrogate.")
+                    break
+                self.fit(X, Y)
+                with open(os.path.join(self.res_dir, 'surrogate.pkl'), 'wb') as f:
+                    pickle.dump({'metrics': self.metrics, 'ranges': self.design.ranges, 'models': self.models}, f)
+                points = self.select(self.batch_size, int(rng.integers(2**31)))
+
+            X_new, Y_new, cases, batch = self._run(points[:self.max_cases - n_run], tag=f"r{round_:02d}_")
+            statuses.update(batch)
+            all_cases += cases
+            n_run += len(cases)
+            self.design.write_case_table(all_cases, os.path.join(self.res_dir, 'case_table.csv'))
+
+            # accuracy of the current surrogate on cases it has not seen
+            error = self.error(X_new, Y_new, np.vstack([Y, Y_new])) if self.models and len(X_new) else None
+            X, Y = np.vstack([X, X_new]), np.vstack([Y, Y_new])
+            row = {'round': round_, 'cases': n_run, 'training_size': len(X)}
+            row.update({f"error_{m}": '' if error is None else float(error[j]) for j, m in enumerate(self.metrics)})
+            rows.append(row)
+            self._log_round(rows)
+            points = None
+
+            if error is not None:
+                self.logger.info(f"Active learning round {round_}: surrogate error "
+                                 f"{dict(zip(self.metrics, np.round(error, 4)))} on {len(X_new)} new case(s).")
+                if np.all(error <= self.target_error):
+                    self.logger.info(f"Target error {self.target_error} reached with {n_run} case(s).")
+                    break
+        return statuses
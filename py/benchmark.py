@@ -0,0 +1,219 @@
+import os
+import json
+import time
+import logging
+import platform
+import shutil
+import resource
+import subprocess
+import configparser
+
+from copy import deepcopy
+from datetime import datetime
+from typing import Dict, List
+
+from generate_dataset import GenerateDataset
+from read_sim_params import ReadSimulationParams
+from simulation_dataset import SimulationDataset
+
+
+PUMLE_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+class PUMLEBenchmark:
+    def __init__(self, config_file: str) -> None:
+        """End-to-end benchmark on the reference cases of `benchmark/benchmark.ini`.
+
+        For each concurrency level, the reference cases run as one sweep and
+        the benchmark reports the wall time per stage (from the case
+        metrics), the simulations per hour, the ingestion throughput of
+        `SimulationDataset` and the peak memory. Results are written as JSON
+        to the results folder and appended to `history.jsonl` there, so that
+        runs can be compared over time.
+
+        Parameters
+        ----------
+        config_file : str
+            Benchmark configuration, see `benchmark/benchmark.ini`. Its
+            relative paths, including `setup`, are taken from the
+            repository root, so the benchmark runs from any folder.
+        """
+        self.logger = logging.getLogger("PUMLELogger")
+        self.config_file = config_file
+
+        config = configparser.ConfigParser(interpolation=None)
+        config.optionxform = str
+        config.read(config_file)
+        if not config.has_section('Benchmark'):
+            self.logger.error(f"Missing section [Benchmark] in '{config_file}'.")
+            raise ValueError(f"Missing section [Benchmark] in '{config_file}'.")
+
+        bench = config['Benchmark']
+        self.setup = bench.get('setup', 'setup.ini')
+        if not os.path.isabs(self.setup):
+            self.setup = os.path.join(PUMLE_ROOT, self.setup)
+        self.deck = bench.get('deck', '')
+        self.concurrency = [int(c) for c in bench.get('concurrency', '1').split(',')]
+        self.repeats = bench.getint('repeats', 1)
+        self.ingest_workers = bench.getint('ingest_workers', 0) or None
+        self.results_dir = bench.get('results_dir', 'benchmark/results')
+        self.reference_cases = {name: dict(config[name]) for name in config.sections() if name != 'Benchmark'}
+
+        self.params = ReadSimulationParams(self.setup).get_params()
+        if self.deck:
+            self.params['Grid']['file_path'] = self._abspath(self.deck)
+        self.results_dir = self._abspath(self.results_dir)
+        self.params.pop('Sweep', None)
+
+    def _abspath(self, path: str) -> str:
+        return path if os.path.isabs(path) else os.path.join(self.params['Paths']['PUMLE_ROOT'], path)
+
+    @staticmethod
+    def _override(params: Dict, overrides: Dict[str, str]) -> None:
+        """Apply 'Section.key = value' overrides (keys matched case-insensitively)."""
+        for name, value in overrides.items():
+            section, _, key = name.partition('.')
+            content = params.setdefault(section, {})
+            key = next((k for k in content if k.lower() == key.lower()), key)
+            try:
+                content[key] = float(value)
+            except ValueError:
+                content[key] = value
+
+    def _cases(self, tag: str) -> List[Dict]:
+        cases = []
+        for name, overrides in self.reference_cases.items():
+            for i in range(self.repeats):
+                case = deepcopy(self.params)
+                self._override(case, overrides)
+                case['Pre-Processing']['case_name'] = f"BENCH_{name}_{tag}_{i}"
+                cases.append(case)
+        return cases
+
+    @staticmethod
+    def _git_revision() -> str:
+        try:
+            out = subprocess.run(['git', 'rev-parse', '--short', 'HEAD'], capture_output=True, text=True,
+                                 cwd=os.path.dirname(os.path.abspath(__file__)))
+            return out.stdout.strip() or 'unknown'
+        except OSError:
+            return 'unknown'
+
+    def _peak_rss_mb(self, summary: Dict) -> Dict[str, float]:
+        """
+        Peak memory [MB] of a level: RSS of this process so far and the
+        largest peak of the MATLAB runs of the level, from their metrics
+        (RUSAGE_CHILDREN would accumulate over the earlier levels).
+        """
+        scale = 1024 ** 2 if platform.system() == 'Darwin' else 1024
+        return {'python': resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / scale,
+                'matlab': summary.get('matlab.peak_memory_mb', {}).get('max')}
+
+    def _ingestion(self, res_dir: str, tag: str) -> Dict:
+        """
+        Time `SimulationDataset.read_files` over the outputs of a sweep, one
+        reference case at a time (their numbers of timesteps differ, so they
+        cannot share the arrays of one read).
+        """
+        dataset = SimulationDataset(res_dir)
+        listed = dataset.list_files()
+        out = {'files': 0, 'bytes': 0, 'seconds': 0.0, 'cases': {}}
+        for name in self.reference_cases:
+            files = [f for f in listed if os.path.basename(f).startswith(f"states_BENCH_{name}_{tag}_")]
+            if not files:
+                continue
+            n_bytes = sum(os.path.getsize(os.path.join(res_dir, f)) for f in files)
+            start = time.perf_counter()
+            dataset.read_files(workers=self.ingest_workers, files=files)
+            elapsed = time.perf_counter() - start
+            out['cases'][name] = {'files': len(files), 'bytes': n_bytes, 'seconds': elapsed}
+            out['files'] += len(files)
+            out['bytes'] += n_bytes
+            out['seconds'] += elapsed
+        if not out['files']:
+            return {}
+        out['mb_per_s'] = out['bytes'] / 1024**2 / out['seconds'] if out['seconds'] > 0 else float('nan')
+        return out
+
+    def run_level(self, workers: int) -> Dict:
+        """
+        Run the reference cases with a given number of concurrent cases.
+
+        Returns
+        -------
+        Dict
+            Wall time, simulations per hour, per-stage metrics, ingestion
+            throughput and peak memory of the level.
+        """
+        params = deepcopy(self.params)
+        params['Paths']['PUMLE_RESULTS'] = os.path.join(self.results_dir, f"c{workers}")
+        params['Paths']['scratch_dir'] = ''
+        params['Execution']['workers'] = workers
+        params['Execution']['resume'] = False
+        # every level pays for the grid processing and simulates all its
+        # cases, so levels are comparable
+        params['Execution']['stage_cache'] = False
+        grid_cache = os.path.join(self.results_dir, f"c{workers}", 'grid_cache')
+        shutil.rmtree(grid_cache, ignore_errors=True)
+        params['Grid']['cache_dir'] = grid_cache
+        if int(params['MATLAB'].get('engine_workers', 0)) > 0:
+            params['MATLAB']['engine_workers'] = workers
+        res_dir = os.path.join(params['Paths']['PUMLE_ROOT'], params['Paths']['PUMLE_RESULTS'])
+
+        gen = GenerateDataset(params)
+        cases = []
+        for case in self._cases(f"c{workers}"):
+            case['Paths'] = deepcopy(params['Paths'])
+            case['Execution'] = deepcopy(params['Execution'])
+            case['MATLAB'] = deepcopy(params['MATLAB'])
+            case['Grid'] = deepcopy(params['Grid'])
+            cases.append(case)
+
+        self.logger.info(f"Benchmark: {len(cases)} case(s) with concurrency {workers}.")
+        start = time.perf_counter()
+        statuses = gen.run_cases(cases)
+        wall = time.perf_counter() - start
+
+        n_done = sum(s == 'done' for s in statuses.values())
+        try:
+            with open(os.path.join(res_dir, 'sweep_metrics.json')) as f:
+                summary = json.load(f)['summary']
+        except (OSError, json.JSONDecodeError, KeyError) as e:
+            self.logger.warning(f"No sweep metrics for concurrency {workers}: {e}")
+            summary = {}
+
+        return {'concurrency': workers, 'cases': len(cases), 'done': n_done,
+                'wall_seconds': wall, 'simulations_per_hour': n_done / wall * 3600 if wall > 0 else 0.0,
+                'stages': {k: v for k, v in summary.items() if '.stages.' in k},
+                'solver': {k: v for k, v in summary.items() if '.solver.' in k},
+                'ingestion': self._ingestion(res_dir, f"c{workers}"),
+                'peak_rss_mb': self._peak_rss_mb(summary)}
+
+    def run(self) -> Dict:
+        """
+        Run all concurrency levels and save the results.
+
+        Returns
+        -------
+        Dict
+            Benchmark results, also saved as `benchmark_<date>.json` and
+            appended to `history.jsonl` in the results folder.
+        """
+        system, hostname, release, *_ = platform.uname()
+        results = {'date': datetime.now().isoformat(timespec='seconds'),
+                   'revision': self._git_revision(),
+                   'host': {'hostname': hostname, 'os': system, 'release': release,
+                            'cpus': os.cpu_count()},
+                   'deck': self.params['Grid']['file_path'],
+                   'reference_cases': self.reference_cases,
+                   'repeats': self.repeats,
+                   'levels': [self.run_level(workers) for workers in self.concurrency]}
+
+        os.makedirs(self.results_dir, exist_ok=True)
+        out = os.path.join(self.results_dir, f"benchmark_{datetime.now().strftime('%Y%m%d_%H%M%S')}.json")
+        with open(out, 'w') as f:
+            json.dump(results, f, indent=2)
+        with open(os.path.join(self.results_dir, 'history.jsonl'), 'a') as f:
+            f.write(json.dumps(results) + '\n')
+        self.logger.info(f"Benchmark results saved to '{out}'.")
+        return results
@@ -0,0 +1,211 @@
+import os
+import logging
+import numpy as np
+
+from concurrent.futures import ProcessPoolExecutor
+from datetime import datetime
+from typing import Dict, List, Optional, Sequence
+
+from dataset_store import ShardedStore
+from field_store import FieldStore
+from run_catalog import RunCatalog
+from sweep_journal import SweepJournal
+from well_placement import parse_wells_list
+
+
+YEAR = 365 * 24 * 3600.0  # MRST's year [s]
+
+
+def _check_fields(fields: Dict[str, np.ndarray], tol: float, block: int = 16) -> Dict[str, Dict]:
+    """
+    Value checks of one case over (timesteps, cells) memory maps, reading
+    `block` timesteps at a time.
+    """
+    n_steps = next(iter(fields.values())).shape[0]
+    bad_values = {f: 0 for f in fields}
+    sat_range, sat_sum = 0.0, 0.0
+    for start in range(0, n_steps, block):
+        chunk = {f: np.asarray(v[start:start + block], dtype=np.float64) for f, v in fields.items()}
+        for f, values in chunk.items():
+            bad_values[f] += int(np.count_nonzero(~np.isfinite(values)))
+        sats = [chunk[f] for f in ('SW', 'SG') if f in chunk]
+        for values in sats:
+            finite = values[np.isfinite(values)]
+            if finite.size:
+                sat_range = max(sat_range, float(np.max(-finite)), float(np.max(finite - 1)))
+        if len(sats) == 2:
+            total = np.abs(sats[0] + sats[1] - 1)
+            total = total[np.isfinite(total)]
+            if total.size:
+                sat_sum = max(sat_sum, float(total.max()))
+
+    return {'finite': {'passed': not any(bad_values.values()), 'non_finite': bad_values},
+            'saturation_range': {'passed': sat_range <= tol, 'max_violation': max(sat_range, 0.0)},
+            'saturation_sum': {'passed': sat_sum <= tol, 'max_error': sat_sum}}
+
+
+def _injection_rate(params: Dict[str, object]) -> Optional[float]:
+    """
+    Total surface injection rate [m3/year] of a case: the wells of its
+    `wells_list` at their own rate or at `CO2_inj`. None if unknown, e.g.
+    for a case with several well scenarios.
+    """
+    default = params.get('Wells.CO2_inj', params.get('Wells.co2_inj'))
+    default = default if isinstance(default, float) else None
+    scenarios = params.get('Wells.scenarios')
+    if isinstance(scenarios, str) and scenarios.strip():
+        return None
+    wells_list = params.get('Wells.wells_list')
+    if not isinstance(wells_list, str) or not wells_list.strip():
+        return default
+    try:
+        rates = [w['rate'] if w['rate'] is not None else default for w in parse_wells_list(wells_list)]
+    except ValueError:
+        return None
+    return None if any(r is None for r in rates) else float(sum(rates))
+
+
+def _check_source(record: Dict, mass_tol: float) -> Dict[str, Dict]:
+    """Time and CO2 mass balance checks of one case, from its simulation store."""
+    source = record.get('source', '')
+    if not source.endswith('.h5') or not os.path.isfile(source):
+        return {'time': {'passed': None}, 'mass_balance': {'passed': None}}
+
+    with FieldStore(source) as store:
+        time = store.time
+        summary = store.summary()
+        rho = store.rho_co2
+
+    dt = np.diff(np.concatenate(([0.0], time)))
+    checks = {'time': {'passed': bool(np.all(dt > 0)), 'non_increasing_steps': int(np.count_nonzero(dt <= 0))}}
+
+    params = record.get('params', {})
+    rate = _injection_rate(params)
+    t_inj = params.get('Schedule.injection_time')
+    if 'co2_mass' not in summary or rho is None or not isinstance(rate, float) or not isinstance(t_inj, float):
+        checks['mass_balance'] = {'passed': None}
+        return checks
+
+    # rates are surface volumes [m3/year], summed over the wells
+    injected = rho * rate * np.minimum(time, t_inj * YEAR) / YEAR
+    in_place = summary['co2_mass']
+    during = time <= t_inj * YEAR * (1 + 1e-9)
+    rel = np.abs(in_place - injected) / np.maximum(injected, 1e-12)
+    # after injection, CO2 may leave through open boundaries but not appear
+    excess = (in_place - injected) / np.maximum(injected, 1e-12)
+    error = max(float(rel[during].max()) if during.any() else 0.0,
+                float(excess[~during].max()) if (~during).any() else 0.0)
+    checks['mass_balance'] = {'passed': error <= mass_tol, 'max_relative_error': error}
+    return checks
+
+
+def _assess_shard(root: str, shard: str, records: Sequence[Dict], tol: float, mass_tol: float) -> List[Dict]:
+    """Worker of `DataQualityAssessment.run`: checks of all the cases of one shard."""
+    store = ShardedStore(root)
+    maps = {}
+    out = []
+    for record in records:
+        try:
+            for f in record.get('fields', []):
+                if f not in maps:
+                    maps[f] = store.open_field(shard, f)
+            checks = _check_fields({f: maps[f][record['offset'], :record['n_steps']]
+                                    for f in record.get('fields', [])}, tol)
+            checks.update(_check_source(record, mass_tol))
+            passed = all(c['passed'] is not False for c in checks.values())
+        except Exception as e:
+            checks, passed = {'error': str(e)}, False
+        out.append({'case_name': record['case_name'], 'status': 'passed' if passed else 'failed',
+                    'checks': checks, 'time': datetime.now().isoformat(timespec='seconds')})
+    return out
+
+
+class DataQualityAssessment:
+    def __init__(self, store: ShardedStore, journal: Optional[SweepJournal] = None,
+                 tol: float = 1e-4, mass_tol: float = 0.05, workers: Optional[int] = None,
+                 catalog: Optional[RunCatalog] = None, max_requeues: int = 2) -> None:
+        """Data-quality checks of the cases of a `ShardedStore`.
+
+        Each case is checked for:
+
+        - NaN or Inf values in its fields;
+        - saturations outside [0, 1] or with |sW + sG - 1| > tol;
+        - monotone simulated time (from its source store);
+        - CO2 mass balance: the mass in place (`/summary/co2_mass`) against
+          the injected mass, total rate of the wells x time x surface
+          density, during injection, and no more than the injected mass
+          afterwards.
+
+        Shards are processed in parallel, each by one worker streaming over
+        its memory-mapped fields a few timesteps at a time, so the dataset
+        is never loaded. Results are appended to the manifest as 'qa'
+        records, and failed cases are requeued in the sweep journal so the
+        next run of the sweep simulates them again, at most `max_requeues`
+        times each.
+        Checks that cannot be evaluated (e.g. no summary) are recorded as
+        not applicable (passed = None) and do not fail the case.
+
+        Parameters
+        ----------
+        store : ShardedStore
+            Store to check.
+        journal : SweepJournal, optional
+            Sweep journal where failed cases are requeued.
+        tol : float
+            Tolerance of the saturation checks.
+        mass_tol : float
+            Relative tolerance of the CO2 mass balance.
+        workers : int, optional
+            Number of worker processes.
+        catalog : RunCatalog, optional
+            Run catalog where the QA status of each case is recorded.
+        max_requeues : int
+            Number of times a case failing the checks is requeued; after
+            that it stays failed in the catalog and the manifest.
+        """
+        self.store = store
+        self.journal = journal
+        self.tol = tol
+        self.mass_tol = mass_tol
+        self.workers = workers
+        self.catalog = catalog
+        self.max_requeues = max_requeues
+        self.logger = logging.getLogger("SimulationDatasetLogger")
+
+    def run(self, case_names: Optional[Sequence[str]] = None) -> Dict[str, str]:
+        """
+        Check the given cases (all cases of the store by default).
+
+        Returns
+        -------
+        Dict[str, str]
+            QA status ('passed' or 'failed') of each case.
+        """
+        manifest = self.store.manifest()
+        names = case_names if case_names is not None else list(manifest)
+        by_shard = {}
+        for name in names:
+            if name in manifest:
+                by_shard.setdefault(manifest[name]['shard'], []).append(manifest[name])
+
+        results = []
+        with ProcessPoolExecutor(max_workers=self.workers) as executor:
+            futures = [executor.submit(_assess_shard, self.store.root, shard, records, self.tol, self.mass_tol)
+                       for shard, records in sorted(by_shard.items())]
+            for future in futures:
+                results += future.result()
+
+        self.store.append_qa(results)
+        if self.catalog is not None:
+            self.catalog.set_qa(results)
+        failed = [r['case_name'] for r in results if r['status'] == 'failed']
+        self.logger.info(f"Data quality: {len(results) - len(failed)} case(s) passed, {len(failed)} failed.")
+
+        if self.journal is not None:
+            for name in failed:
+                if self.journal.requeues(name, reason='qa') >= self.max_requeues:
+                    self.logger.warning(f"Case '{name}' failed the data-quality checks again; "
+                                        f"not requeued after {self.max_requeues} attempt(s).")
+                elif self.journal.requeue(name, reason='qa'):
+                    self.logger.info(f"Case '{name}' requeued after failing the data-quality checks.")
+        return {r['case_name']: r['status'] for r in results}
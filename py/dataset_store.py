@@ -0,0 +1,293 @@
+import os
+import re
+import json
+import shutil
+import logging
+import configparser
+import numpy as np
+
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple
+
+from field_store import FieldStore
+from simulation_dataset import SimulationDataset, STATE_FIELDS
+
+
+MANIFEST_FILE = 'manifest.jsonl'
+GRID_FILE = 'grid.npz'
+CASE_FILE_PATTERN = re.compile(r"states_(.+)\.(?:h5|mat)$")
+
+
+class ShardedStore:
+    def __init__(self, root: str) -> None:
+        """Append-only sharded dataset store with a manifest index.
+
+        Layout::
+
+            root/manifest.jsonl          one JSON record per line
+            root/grid.npz                index_map and cart_dims, shared by all 3D cases
+            root/grid_ve.npz             same, for VE cases (top surface grid)
+            root/grid_coarse.npz         same, for coarse cases (mapped back to
+                                         the fine active cells)
+            root/shard_00000/<F>.npy     (cases, timesteps, active cells) per field
+
+        Each new batch of cases goes into a new shard, so existing shards
+        are never rewritten. The manifest maps each `case_name` to its input
+        parameters, fidelity ('3d', 'coarse' or 've'), shard and row offset; records
+        are only appended, and the last record of a case wins. A shard only
+        holds cases of one fidelity.
+
+        Parameters
+        ----------
+        root : str
+            Store folder (created if needed).
+        """
+        self.root = root
+        self.logger = logging.getLogger("SimulationDatasetLogger")
+        os.makedirs(root, exist_ok=True)
+
+    def _append_records(self, records: Iterable[Dict]) -> None:
+        """Append records to the manifest and flush them to disk."""
+        with open(os.path.join(self.root, MANIFEST_FILE), 'a') as f:
+            for record in records:
+                f.write(json.dumps(record) + '\n')
+            f.flush()
+            os.fsync(f.fileno())
+
+    def records(self, kind: str = 'case') -> List[Dict]:
+        """All manifest records of a kind, in the order they were appended."""
+        path = os.path.join(self.root, MANIFEST_FILE)
+        if not os.path.isfile(path):
+            return []
+        with open(path) as f:
+            return [r for r in (json.loads(line) for line in f if line.strip()) if r.get('type') == kind]
+
+    def manifest(self) -> Dict[str, Dict]:
+        """
+        Current entry of each case.
+
+        Returns
+        -------
+        Dict[str, Dict]
+            Latest case record (params, shard, offset, ...) keyed by case name.
+        """
+        out = {}
+        for record in self.records('case'):
+            out[record['case_name']] = record
+        return out
+
+    def qa(self) -> Dict[str, Dict]:
+        """Latest data-quality record of each case (see `DataQualityAssessment`), keyed by case name."""
+        return {r['case_name']: r for r in self.records('qa')}
+
+    def append_qa(self, results: Iterable[Dict]) -> None:
+        """Append data-quality records ('case_name', 'status', 'checks') to the manifest."""
+        self._append_records({'type': 'qa', **r} for r in results)
+
+    @staticmethod
+    def read_case_params(report_path: str) -> Dict[str, object]:
+        """
+        Input parameters of a case from its `report.txt`, flattened as
+        'Section.key' (numbers are converted to float).
+        """
+        with open(report_path) as f:
+            text = f.read()
+        config = configparser.ConfigParser(interpolation=None)
+        config.optionxform = str
+        config.read_string(text[text.find('\n['):] if not text.startswith('[') else text)
+
+        params = {}
+        for section in config.sections():
+            for key, value in config.items(section):
+                try:
+                    params[f"{section}.{key}"] = float(value)
+                except ValueError:
+                    params[f"{section}.{key}"] = value
+        return params
+
+    @staticmethod
+    def case_fidelity(params: Dict[str, object]) -> str:
+        """Fidelity of a case from its parameters: '3d', 'coarse' or 've'."""
+        fidelity = str(params.get('Pre-Processing.model_type', '3d')).lower()
+        coarsen = str(params.get('Grid.coarsen', '1, 1, 1')).replace(',', ' ').split()
+        if fidelity == '3d' and any(float(c) > 1 for c in coarsen):
+            return 'coarse'
+        return fidelity
+
+    def _next_shard(self) -> str:
+        shards = [d for d in os.listdir(self.root) if d.startswith('shard_')]
+        return f"shard_{len(shards):05d}"
+
+    def _grid_path(self, fidelity: str) -> str:
+        return os.path.join(self.root, GRID_FILE if fidelity == '3d' else f"grid_{fidelity}.npz")
+
+    def _check_grid(self, index_map: np.ndarray, cart_dims: Tuple[int, ...], fidelity: str = '3d') -> None:
+        """Store the grid layout on first use; reject cases with a different one."""
+        path = self._grid_path(fidelity)
+        if not os.path.isfile(path):
+            np.savez(path, index_map=index_map, cart_dims=np.array(cart_dims))
+            return
+        grid = np.load(path)
+        if tuple(grid['cart_dims']) != tuple(cart_dims) or not np.array_equal(grid['index_map'], index_map):
+            raise ValueError("Cases do not share the grid layout of the store.")
+
+    @staticmethod
+    def _has_fields(file_path: str, fields: Sequence[str]) -> bool:
+        """Whether a simulation file holds the fields, i.e. is not a summary-only store ([Output] fields = False)."""
+        if not file_path.endswith('.h5'):
+            return True
+        try:
+            with FieldStore(file_path) as store:
+                available = store.fields
+        except Exception:
+            # unreadable files are left to the ingestion, which marks them invalid
+            return True
+        return all(FieldStore.dataset_name(f) in available for f in fields)
+
+    def ingest(self, results_dir: str, fields: Optional[Sequence[str]] = None,
+               shard_size: int = 64, workers: Optional[int] = None,
+               case_names: Optional[Iterable[str]] = None) -> List[str]:
+        """
+        Add the simulation files under a results folder that are not in the
+        store yet. Summary-only stores, without the requested fields, are
+        skipped.
+
+        Parameters
+        ----------
+        results_dir : str
+            Folder searched (recursively) for `states_<case>.h5/.mat` files.
+            The parameters of each case are read from the `report.txt` next
+            to its file.
+        fields : Sequence[str], optional
+            Fields to store; P, SW and SG by default.
+        shard_size : int
+            Maximum number of cases per shard.
+        workers : int, optional
+            Number of ingestion worker processes.
+        case_names : Iterable[str], optional
+            Only ingest these cases, e.g. the runs done according to the
+            `RunCatalog`; all cases found by default.
+
+        Returns
+        -------
+        List[str]
+            Names of the cases added.
+        """
+        fields = [f.upper() for f in (fields or STATE_FIELDS)]
+        dataset = SimulationDataset(results_dir)
+        known = self.manifest()
+
+        # cases that failed the quality checks are ingested again once
+        # their output has been rewritten
+        qa = self.qa()
+        for name in [n for n, r in qa.items() if r['status'] == 'failed' and n in known]:
+            source = known[name].get('source', '')
+            if os.path.isfile(source) and os.path.getmtime(source) != known[name].get('source_mtime'):
+                known.pop(name)
+
+        allowed = set(case_names) if case_names is not None else None
+        pending = {}
+        for name in dataset.list_files():
+            match = CASE_FILE_PATTERN.search(os.path.basename(name))
+            if match and match.group(1) not in known and (allowed is None or match.group(1) in allowed):
+                if not self._has_fields(os.path.join(results_dir, name), fields):
+                    self.logger.info(f"Case '{match.group(1)}' has no stored fields {fields}, not ingested.")
+                    continue
+                report = os.path.join(results_dir, os.path.dirname(name), 'report.txt')
+                params = self.read_case_params(report) if os.path.isfile(report) else {}
+                fidelity = self.case_fidelity(params)
+                pending.setdefault(fidelity, []).append((match.group(1), name, params))
+
+        batches = [(fidelity, cases[start:start + shard_size])
+                   for fidelity, cases in pending.items() for start in range(0, len(cases), shard_size)]
+
+        added = []
+        for fidelity, batch in batches:
+            shard = self._next_shard()
+            shard_dir = os.path.join(self.root, shard)
+
+            try:
+                dataset.read_files(fields=fields, workers=workers, out_dir=shard_dir, files=[b[1] for b in batch])
+                self._check_grid(dataset.index_map, dataset.cart_dims, fidelity)
+            except Exception:
+                # no record points to the shard yet, so a rejected batch leaves nothing behind
+                shutil.rmtree(shard_dir, ignore_errors=True)
+                raise
+            valid = np.load(os.path.join(shard_dir, 'valid.npy'))
+            n_steps = int(np.load(os.path.join(shard_dir, f"{fields[0]}.npy"), mmap_mode='r').shape[1])
+
+            records = []
+            for offset, ((case_name, name, params), ok) in enumerate(zip(batch, valid)):
+                if not ok:
+                    continue
+                source = os.path.join(results_dir, name)
+                records.append({'type': 'case', 'case_name': case_name, 'params': params,
+                                'fidelity': fidelity, 'shard': shard, 'offset': offset, 'n_steps': n_steps,
+                                'fields': fields, 'source': source, 'source_mtime': os.path.getmtime(source)})
+            self._append_records(records)
+            added += [r['case_name'] for r in records]
+            self.logger.info(f"Shard '{shard}' written with {len(records)} case(s).")
+
+        return added
+
+    def select(self, ranges: Optional[Dict[str, Tuple[float, float]]] = None, **equals) -> List[Dict]:
+        """
+        Select cases by parameter values, using the manifest only.
+
+        Parameters
+        ----------
+        ranges : Dict[str, Tuple[float, float]], optional
+            Closed intervals keyed by 'Section.key', e.g.
+            {'Fluid.XNaCl': (0.1, 0.2)}.
+        equals :
+            Exact matches on other record entries, e.g. fidelity='ve'.
+
+        Returns
+        -------
+        List[Dict]
+            Matching case records.
+        """
+        out = []
+        for record in self.manifest().values():
+            params = record.get('params', {})
+            ok = all(isinstance(params.get(k), float) and lo <= params[k] <= hi
+                     for k, (lo, hi) in (ranges or {}).items())
+            ok = ok and all(record.get(k) == v for k, v in equals.items())
+            if ok:
+                out.append(record)
+        return out
+
+    def grid(self, fidelity: str = '3d') -> Tuple[np.ndarray, Tuple[int, ...]]:
+        """Active cell index map and logical dimensions of the stored cases of a fidelity."""
+        grid = np.load(self._grid_path(fidelity))
+        return grid['index_map'], tuple(int(v) for v in grid['cart_dims'])
+
+    def open_field(self, shard: str, field: str) -> np.ndarray:
+        """Memory-map one field of a shard (read-only)."""
+        return np.load(os.path.join(self.root, shard, f"{field.upper()}.npy"), mmap_mode='r')
+
+    def load(self, records: Sequence[Dict], field: str, steps=None) -> np.ndarray:
+        """
+        Load one field of the given cases; only their shards are opened.
+
+        Parameters
+        ----------
+        records : Sequence[Dict]
+            Case records, e.g. from `select`.
+        field : str
+            Field name ('P', 'SW' or 'SG').
+        steps : slice or sequence of int, optional
+            Timesteps (0-based); all of them by default.
+
+        Returns
+        -------
+        np.ndarray
+            Array of shape (cases, timesteps, active cells), in record order.
+        """
+        steps = slice(None) if steps is None else steps
+        maps = {}
+        rows = []
+        for record in records:
+            if record['shard'] not in maps:
+                maps[record['shard']] = self.open_field(record['shard'], field)
+            rows.append(maps[record['shard']][record['offset'], steps])
+        return np.stack(rows) if rows else np.empty((0,))
@@ -0,0 +1,267 @@
+import os
+import sys
+import glob
+import json
+import shutil
+import logging
+import subprocess
+
+from copy import deepcopy
+from typing import Callable, Dict, List, Optional
+
+from sweep_journal import SweepJournal
+from sweep_scheduler import SweepScheduler
+
+
+BACKENDS = ('local', 'slurm', 'dask')
+
+
+def run_remote_case(case: Dict, node_scratch: str = '') -> str:
+    """
+    Run one case on a cluster node and collect its outputs.
+
+    The case runs in a scratch directory on the node (`node_scratch`, with
+    environment variables expanded, e.g. '$TMPDIR'); its folder is then
+    copied to the case directory in the shared results folder, where the
+    journal, the metrics and the dataset store expect it. Outputs already
+    in the shared folder are copied to the node first, so interrupted cases
+    restart from their last streamed timestep. The grid cache key and
+    side-car path come with the case, so the deck is not hashed again on
+    every task.
+
+    Returns
+    -------
+    str
+        Completion status: 'done' or 'failed'.
+    """
+    from generate_dataset import GenerateDataset
+
+    logger = logging.getLogger("PUMLELogger")
+    case = deepcopy(case)
+    # the grid was prepared on the submitting host
+    gen = GenerateDataset(case, prepare_grid=False)
+    shared_dir = gen._case_dir(case)
+
+    scratch = os.path.expandvars(node_scratch) if node_scratch else ''
+    if scratch and '$' not in scratch:
+        case['Paths']['scratch_dir'] = os.path.join(scratch, 'pumle')
+    local_dir = gen._case_dir(case)
+    if local_dir != shared_dir and os.path.isdir(shared_dir):
+        shutil.copytree(shared_dir, local_dir, dirs_exist_ok=True)
+
+    status = 'failed'
+    try:
+        gen._run_case(case)
+        status = 'done'
+    except Exception as e:
+        logger.error(f"Case '{case['Pre-Processing']['case_name']}' failed on {os.uname().nodename}: {e}")
+    finally:
+        if local_dir != shared_dir and os.path.isdir(local_dir):
+            shutil.copytree(local_dir, shared_dir, dirs_exist_ok=True)
+            shutil.rmtree(local_dir, ignore_errors=True)
+    return status
+
+
+def _run_dask_case(case: Dict, node_scratch: str = '') -> str:
+    """`run_remote_case` raising on failure, so that Dask retries the task."""
+    if run_remote_case(case, node_scratch) == 'failed':
+        raise RuntimeError(f"Case '{case['Pre-Processing']['case_name']}' failed.")
+    return 'done'
+
+
+class ExecutionBackend:
+    def __init__(self, params: Dict) -> None:
+        """Where the cases of a sweep run (`[Execution] backend`).
+
+        Parameters
+        ----------
+        params : Dict
+            Simulation parameters; the `[Execution]` section configures the backend.
+        """
+        self.params = params
+        self.execution = params.get('Execution', {})
+        self.logger = logging.getLogger("PUMLELogger")
+        self.retries = int(self.execution.get('retries', 0))
+
+    def res_dir(self) -> str:
+        return os.path.join(self.params['Paths']['PUMLE_ROOT'], self.params['Paths']['PUMLE_RESULTS'])
+
+    def run(self, cases: List[Dict], runner: Callable[[Dict], Optional[str]], journal: SweepJournal,
+            status_file: Optional[str] = None, skip: Optional[Callable[[Dict], bool]] = None) -> Dict[str, str]:
+        """
+        Run the cases and return the status ('done' or 'failed') of each,
+        keyed by case name. `runner` runs one case on the local node.
+        """
+        raise NotImplementedError
+
+    def _write_status(self, result: Dict[str, str], status_file: Optional[str]) -> None:
+        if not status_file:
+            return
+        try:
+            with open(status_file, 'w') as f:
+                json.dump(result, f, indent=2)
+        except Exception as e:
+            self.logger.error(f"Failed to write sweep status file '{status_file}': {e}")
+
+    def _todo(self, cases: List[Dict], journal: SweepJournal,
+              skip: Optional[Callable[[Dict], bool]]) -> List[Dict]:
+        todo = [case for case in cases if skip is None or not skip(case)]
+        if len(todo) < len(cases):
+            self.logger.info(f"Skipping {len(cases) - len(todo)} case(s) already completed.")
+        for case in todo:
+            journal.record(case, 'pending')
+        return todo
+
+
+class LocalBackend(ExecutionBackend):
+    """Cases run concurrently on this node with the `SweepScheduler`."""
+
+    def run(self, cases, runner, journal, status_file=None, skip=None):
+        scheduler = SweepScheduler(runner, workers=int(self.execution.get('workers', 0)),
+                                   memory_per_case=float(self.execution.get('memory_per_case', 4.0)),
+                                   journal=journal)
+        result = scheduler.run(cases, status_file, skip=skip)
+
+        # failed cases are retried one at a time; they restart from their
+        # last streamed timestep
+        for attempt in range(self.retries):
+            failed = [c for c in cases if result[c['Pre-Processing']['case_name']] == 'failed']
+            if not failed:
+                break
+            self.logger.info(f"Retrying {len(failed)} failed case(s), attempt {attempt + 1} of {self.retries}.")
+            for case in failed:
+                case.setdefault('Output', {})['restart'] = True
+            result.update(scheduler.run(failed))
+        self._write_status(result, status_file)
+        return result
+
+
+class SlurmBackend(ExecutionBackend):
+    """Cases run as a SLURM job array on the nodes of a cluster.
+
+    The case table is written to `<results>/slurm/case_table.json` and each
+    of the `slurm_tasks` array tasks runs its own contiguous slice of it
+    (`run_task.py`), on node-local scratch, writing the status of its cases
+    to `status_<attempt>_<task>.json`. `sbatch --wait` blocks until the
+    array completes; failed cases are then resubmitted as a new array, up to
+    `retries` times.
+    """
+
+    def _script(self, work_dir: str, table: str, n_tasks: int, attempt: int) -> str:
+        py_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], 'py')
+        concurrency = int(self.execution.get('slurm_concurrency', 0))
+        array = f"0-{n_tasks - 1}" + (f"%{concurrency}" if concurrency > 0 else '')
+        options = [o.strip() for o in str(self.execution.get('slurm_options', '')).split(';') if o.strip()]
+        lines = ['#!/bin/bash',
+                 f'#SBATCH --job-name=pumle_{attempt}',
+                 f'#SBATCH --array={array}',
+                 f'#SBATCH --output={os.path.join(work_dir, "slurm_%A_%a.log")}',
+                 f'#SBATCH --mem={int(float(self.execution.get("memory_per_case", 4.0)) * 1024)}M',
+                 *[f'#SBATCH {o}' for o in options],
+                 '',
+                 f'cd "{py_dir}"',
+                 f'"{sys.executable}" run_task.py "{table}" "$SLURM_ARRAY_TASK_ID" {attempt}',
+                 '']
+        path = os.path.join(work_dir, f'pumle_array_{attempt}.sh')
+        with open(path, 'w') as f:
+            f.write('\n'.join(lines))
+        return path
+
+    def _submit(self, cases: List[Dict], attempt: int) -> Dict[str, str]:
+        work_dir = os.path.join(self.res_dir(), 'slurm')
+        os.makedirs(work_dir, exist_ok=True)
+        n_tasks = int(self.execution.get('slurm_tasks', 0)) or len(cases)
+        n_tasks = max(1, min(n_tasks, len(cases)))
+
+        table = os.path.join(work_dir, 'case_table.json')
+        with open(table, 'w') as f:
+            json.dump({'n_tasks': n_tasks, 'node_scratch': self.execution.get('node_scratch', '') or '$TMPDIR',
+                       'cases': cases}, f, default=str)
+
+        # statuses of a previous sweep must not be taken for the ones of this array
+        for path in glob.glob(os.path.join(work_dir, f'status_{attempt}_*.json')):
+            os.remove(path)
+
+        script = self._script(work_dir, table, n_tasks, attempt)
+        self.logger.info(f"Submitting {len(cases)} case(s) as a SLURM array of {n_tasks} task(s).")
+        try:
+            subprocess.run(['sbatch', '--wait', script], check=True, capture_output=True, text=True)
+        except (OSError, subprocess.CalledProcessError) as e:
+            # the array fails as a whole when any task fails; statuses tell which cases
+            self.logger.warning(f"SLURM array {attempt} did not complete cleanly: {e}")
+
+        result = {c['Pre-Processing']['case_name']: 'failed' for c in cases}
+        for task in range(n_tasks):
+            try:
+                with open(os.path.join(work_dir, f'status_{attempt}_{task}.json')) as f:
+                    result.update({k: v for k, v in json.load(f).items() if k in result})
+            except (OSError, json.JSONDecodeError):
+                continue
+        return result
+
+    def run(self, cases, runner, journal, status_file=None, skip=None):
+        todo = self._todo(cases, journal, skip)
+        result = {c['Pre-Processing']['case_name']: 'done' for c in cases}
+        for attempt in range(self.retries + 1):
+            if not todo:
+                break
+            for case in todo:
+                journal.record(case, 'running')
+            statuses = self._submit(todo, attempt)
+            for case in todo:
+                name = case['Pre-Processing']['case_name']
+                journal.record(case, statuses[name], **({'attempt': attempt} if attempt else {}))
+            result.update(statuses)
+            todo = [c for c in todo if statuses[c['Pre-Processing']['case_name']] == 'failed']
+            for case in todo:
+                case.setdefault('Output', {})['restart'] = True
+
+        self._write_status(result, status_file)
+        return result
+
+
+class DaskBackend(ExecutionBackend):
+    """Cases run as tasks of a Dask distributed cluster (`[Execution]
+    dask_address`, e.g. a dask-jobqueue scheduler); a local cluster is
+    started when the address is empty. Dask retries failed tasks itself.
+    """
+
+    def run(self, cases, runner, journal, status_file=None, skip=None):
+        from dask.distributed import Client, as_completed
+
+        todo = self._todo(cases, journal, skip)
+        result = {c['Pre-Processing']['case_name']: 'done' for c in cases}
+        address = self.execution.get('dask_address', '') or None
+        node_scratch = self.execution.get('node_scratch', '')
+
+        with Client(address) as client:
+            futures = {}
+            for case in todo:
+                journal.record(case, 'running')
+                future = client.submit(_run_dask_case, case, node_scratch, retries=self.retries,
+                                       key=f"pumle-{case['Pre-Processing']['case_name']}")
+                futures[future] = case
+
+            for future in as_completed(futures):
+                case = futures[future]
+                name = case['Pre-Processing']['case_name']
+                try:
+                    status = future.result()
+                    extra = {}
+                except Exception as e:
+                    self.logger.error(f"Case '{name}' failed on the Dask cluster: {e}")
+                    status, extra = 'failed', {'error': str(e)}
+                journal.record(case, status, **extra)
+                result[name] = status
+
+        self._write_status(result, status_file)
+        return result
+
+
+def make_backend(params: Dict) -> ExecutionBackend:
+    """Execution backend selected by `[Execution] backend`."""
+    name = str(params.get('Execution', {}).get('backend', 'local')).strip().lower()
+    if name not in BACKENDS:
+        logging.getLogger("PUMLELogger").error(f"Unknown execution backend '{name}'. Valid backends: {BACKENDS}.")
+        raise ValueError(f"Unknown execution backend '{name}'.")
+    return {'local': LocalBackend, 'slurm': SlurmBackend, 'dask': DaskBackend}[name](params)
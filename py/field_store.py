@@ -0,0 +1,243 @@
+import logging
+import numpy as np
+
+from typing import Dict, Optional, Sequence, Union
+
+
+# Names used by SimulationDataset mapped to the datasets of the store
+FIELD_ALIASES = {'P': 'pressure', 'SW': 'sW', 'SG': 'sG', 'SGMAX': 'sGmax'}
+
+# Integer scale of the 16-bit saturation codecs (`quantize16PUMLE.m`)
+QUANT16_SCALE = 65535.0
+
+
+class FieldStore:
+    def __init__(self, file_path: str) -> None:
+        """Read-only access to the HDF5 field store written by `co2lab3DPUMLE.m`.
+
+        Fields are float32 arrays of shape (timesteps, active cells), one
+        chunk per timestep, so a timestep is read without touching the rest
+        of the file. Saturations may be stored quantized to 16 bits, as
+        deltas between timesteps or as sparse (cell, value) lists (see
+        `fieldCodecPUMLE.m`); `read` decodes them transparently.
+
+        Stores of coarsened runs hold the fields over coarse blocks
+        together with the fine-to-coarse `partition`; `read` maps them back
+        to the fine active cells.
+
+        Parameters
+        ----------
+        file_path : str
+            Path to a `states_<case>.h5` file.
+        """
+        import h5py
+
+        self.file_path = file_path
+        self.logger = logging.getLogger("SimulationDatasetLogger")
+        self._file = h5py.File(file_path, 'r')
+
+    def __enter__(self) -> "FieldStore":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def close(self) -> None:
+        self._file.close()
+
+    @staticmethod
+    def dataset_name(field: str) -> str:
+        """Store dataset of a field given as 'P'/'SW'/'SG' or by its dataset name."""
+        return FIELD_ALIASES.get(field.upper(), field)
+
+    @property
+    def fields(self) -> Sequence[str]:
+        return [name for name in ('pressure', 'sW', 'sG', 'sGmax') if name in self._file]
+
+    @property
+    def n_steps(self) -> int:
+        return int(self._file['time'].shape[0])
+
+    @property
+    def n_cells(self) -> int:
+        """Number of (fine) active cells."""
+        return int(self._file['grid/indexMap'].size)
+
+    @property
+    def partition(self) -> Optional[np.ndarray]:
+        """Coarse block (0-based) of each fine active cell, or None for fine-grid stores."""
+        if 'grid/partition' not in self._file:
+            return None
+        return self._file['grid/partition'][:].ravel().astype(np.int64) - 1
+
+    @property
+    def time(self) -> np.ndarray:
+        return self._file['time'][:].ravel()
+
+    @property
+    def cart_dims(self) -> tuple:
+        return tuple(int(v) for v in self._file['grid/cartDims'][:].ravel())
+
+    @property
+    def index_map(self) -> np.ndarray:
+        """Linear Cartesian index (0-based, Fortran order) of each active cell."""
+        return self._file['grid/indexMap'][:].ravel().astype(np.int64) - 1
+
+    @property
+    def fidelity(self) -> str:
+        """Model the fields come from: '3d', or 've' (columns of the top surface grid)."""
+        value = self._file.attrs.get('fidelity', '3d')
+        return value.decode() if isinstance(value, bytes) else str(value)
+
+    @property
+    def has_summary(self) -> bool:
+        return 'summary' in self._file
+
+    def summary(self) -> Dict[str, np.ndarray]:
+        """
+        Plume summary series written during the run (`plumeSummaryPUMLE.m`):
+        footprint area and extent, maximum saturation, CO2 mass by trapping
+        mechanism and pressure buildup, one value per timestep, with 'time'.
+        Empty for stores written without a summary.
+        """
+        if not self.has_summary:
+            return {}
+        out = {'time': self.time}
+        for name, dset in self._file['summary'].items():
+            out[name] = dset[:].ravel().astype(np.float64)
+        return out
+
+    @property
+    def rho_co2(self) -> Optional[float]:
+        """CO2 surface density of the run [kg/m3], from the summary; None if not recorded."""
+        rho = self._file['summary'].attrs.get('rhoGS') if self.has_summary else None
+        return None if rho is None else float(np.ravel(rho)[0])
+
+    @property
+    def attrs(self) -> Dict:
+        return dict(self._file.attrs)
+
+    def codec(self, field: str) -> str:
+        """Encoding of a field: 'float32', 'quant16', 'quant16-delta', 'sparse' or 'sparse-quant16'."""
+        value = self._file[self.dataset_name(field)].attrs.get('codec', 'float32')
+        return value.decode() if isinstance(value, bytes) else str(value)
+
+    def max_abs_error(self, field: str) -> float:
+        """Maximum absolute error of the stored values of a field, from its encoding."""
+        return float(np.ravel(self._file[self.dataset_name(field)].attrs.get('max_abs_error', 0.0))[0])
+
+    def _decode(self, name: str, idx: np.ndarray, dtype: np.dtype) -> np.ndarray:
+        """Decode the given timesteps of an encoded saturation field."""
+        node = self._file[name]
+        codec = self.codec(name)
+
+        if codec == 'quant16':
+            uniq, inverse = np.unique(idx, return_inverse=True)
+            return (node[uniq, :] / QUANT16_SCALE).astype(dtype)[inverse]
+
+        if codec == 'quant16-delta':
+            # accumulate the deltas from the keyframe before the first step
+            interval = int(np.ravel(node.attrs['keyframe_interval'])[0])
+            lo = int(idx.min()) // interval * interval
+            block = node[lo:int(idx.max()) + 1, :].astype(np.int64)
+            for r in range(1, block.shape[0]):
+                if (lo + r) % interval:
+                    block[r] += block[r - 1]
+            return (block[idx - lo] / QUANT16_SCALE).astype(dtype)
+
+        if codec in ('sparse', 'sparse-quant16'):
+            n = int(np.ravel(node.attrs['n_cells'])[0])
+            ptr = node['ptr'][:].reshape(-1, 2)
+            out = np.zeros((idx.size, n), dtype=dtype)
+            for i, step in enumerate(idx):
+                start, count = (int(v) for v in ptr[step])
+                if count:
+                    cells = node['index'][start:start + count].ravel().astype(np.int64) - 1
+                    values = node['values'][start:start + count].ravel()
+                    out[i, cells] = values / QUANT16_SCALE if codec == 'sparse-quant16' else values
+            return out
+
+        raise ValueError(f"Unknown codec '{codec}' of field '{name}' in '{self.file_path}'.")
+
+    def _mappable(self, dset) -> bool:
+        """Whether each timestep of a dataset is a raw, uncompressed chunk in the file."""
+        if dset.attrs.get('codec', 'float32') not in ('float32', b'float32'):
+            return False
+        return dset.chunks is not None and dset.chunks[0] == 1 and dset.chunks[1] == dset.shape[1] \
+            and dset.compression is None and not dset.shuffle
+
+    def map_step(self, field: str, step: int) -> np.ndarray:
+        """
+        Memory-map one timestep of a field (read-only, no copy).
+
+        Only uncompressed stores (`[Output] compression = 0`) can be mapped;
+        for compressed ones the chunk is decoded and returned instead.
+        Coarse stores are returned over their blocks.
+
+        Parameters
+        ----------
+        field : str
+            Field name ('P', 'SW', 'SG' or a dataset name).
+        step : int
+            Timestep (0-based).
+
+        Returns
+        -------
+        np.ndarray
+            Array of shape (active cells,) or (coarse blocks,).
+        """
+        dset = self._file[self.dataset_name(field)]
+        if self.codec(field) != 'float32':
+            return self._decode(self.dataset_name(field), np.array([step]), np.float32)[0]
+        if not self._mappable(dset):
+            return dset[step, :]
+        info = dset.id.get_chunk_info_by_coord((int(step), 0))
+        return np.memmap(self.file_path, dtype=dset.dtype, mode='r',
+                         offset=info.byte_offset, shape=(dset.shape[1],))
+
+    def read(self, field: str, steps: Optional[Union[int, slice, Sequence[int]]] = None,
+             dtype: np.dtype = np.float32, fine: bool = True) -> np.ndarray:
+        """
+        Read a field over active cells.
+
+        Timesteps are memory-mapped chunk by chunk when the store is
+        uncompressed, so reading a few timesteps touches only those chunks.
+
+        Parameters
+        ----------
+        field : str
+            Field name ('P', 'SW', 'SG' or a dataset name).
+        steps : int, slice or sequence of int, optional
+            Timesteps to read (0-based); all of them by default.
+        dtype : np.dtype
+            Output dtype.
+        fine : bool
+            For coarse stores, map the block values back to the fine active
+            cells (piecewise constant); otherwise return them per block.
+
+        Returns
+        -------
+        np.ndarray
+            Array of shape (timesteps, active cells), or (active cells,) for
+            a single integer step.
+        """
+        dset = self._file[self.dataset_name(field)]
+        idx = np.arange(self.n_steps)[slice(None) if steps is None else steps]
+        scalar = np.ndim(idx) == 0
+        idx = np.atleast_1d(idx)
+
+        if self.codec(field) != 'float32':
+            out = self._decode(self.dataset_name(field), idx, dtype)
+        elif self._mappable(dset):
+            out = np.empty((idx.size, dset.shape[1]), dtype=dtype)
+            for i, step in enumerate(idx):
+                out[i] = self.map_step(field, step)
+        else:
+            # h5py fancy indexing needs increasing, unique indices
+            uniq, inverse = np.unique(idx, return_inverse=True)
+            out = dset[uniq, :].astype(dtype, copy=False)[inverse]
+
+        partition = self.partition if fine else None
+        if partition is not None:
+            out = out[:, partition]
+        return out[0] if scalar else out
@@ -0,0 +1,116 @@
+import numpy as np
+
+from typing import Dict, List
+
+
+# Driesner (2007) coefficients of the liquid NaCl density
+DRIESNER_M = (58443, 23.772, 0.018639, -1.9687e-6, -1.5259e-5, 5.5058e-8)
+
+# Mao & Duan (2009) coefficients of the relative brine viscosity
+MAO_DUAN_ABC = (-0.21319213, 0.13651589e-2, -0.12191756e-5,
+                0.69161945e-1, -0.27292263e-3, 0.20852448e-6,
+                -0.25988855e-2, 0.77989227e-5)
+
+# Mao & Duan (2009) coefficients of the pure water viscosity
+MAO_DUAN_D = np.array([0.28853170e7, -0.11072577e5, -0.90834095e1, 0.30925651e-1, -0.27407100e-4,
+                       -0.19283851e7, 0.56216046e4, 0.13827250e2, -0.47609523e-1, 0.35545041e-4])
+
+NACL_MOLAR_MASS = 58.44 / 1000  # [kg/mol]
+
+
+def brine_density(p, T, x_nacl, rho_h2o=1000.0) -> np.ndarray:
+    """
+    Brine density by mass-fraction mixing of pure water and liquid NaCl
+    (Driesner, 2007), as in `co2lab3DPUMLE.m`. Inputs are broadcast.
+
+    Parameters
+    ----------
+    p : array_like
+        Pressure [MPa].
+    T : array_like
+        Temperature [ºC].
+    x_nacl : array_like
+        NaCl mass fraction.
+    rho_h2o : array_like
+        Pure water density [kg/m3].
+
+    Returns
+    -------
+    np.ndarray
+        Brine density [kg/m3].
+    """
+    p, T, x_nacl, rho_h2o = (np.asarray(v, dtype=np.float64) for v in (p, T, x_nacl, rho_h2o))
+    m0, m1, m2, m3, m4, m5 = DRIESNER_M
+
+    rho_nacl_0 = m0 / (m1 + m2 * T + m3 * T**2)
+    c_nacl = m4 + m5 * T
+    p_bar = 10 * p
+    rho_nacl = rho_nacl_0 / (1 - 0.1 * np.log(1 + 10 * p_bar * c_nacl))
+
+    return rho_h2o * (1 - x_nacl) + rho_nacl * x_nacl
+
+
+def brine_viscosity(T, x_nacl, rho_h2o=1000.0) -> np.ndarray:
+    """
+    Brine viscosity of Mao & Duan (2009), as in `co2lab3DPUMLE.m`. It does
+    not depend on pressure. Inputs are broadcast.
+
+    Parameters
+    ----------
+    T : array_like
+        Temperature [ºC].
+    x_nacl : array_like
+        NaCl mass fraction.
+    rho_h2o : array_like
+        Pure water density [kg/m3].
+
+    Returns
+    -------
+    np.ndarray
+        Brine viscosity [Pa s].
+    """
+    T, x_nacl, rho_h2o = (np.asarray(v, dtype=np.float64) for v in (T, x_nacl, rho_h2o))
+    a0, a1, a2, b0, b1, b2, c0, c1 = MAO_DUAN_ABC
+
+    t_k = T + 273.15
+    moly = x_nacl / (NACL_MOLAR_MASS * (1 - x_nacl))
+
+    A = a0 + a1 * t_k + a2 * t_k**2
+    B = b0 + b1 * t_k + b2 * t_k**2
+    C = c0 + c1 * t_k
+    mu_rel = np.exp(A * moly + B * moly**2 + C * moly**3)
+
+    # sum over the coefficients on a trailing axis (rho_h2o in g/cm3)
+    t = t_k[..., None]
+    log_mu = (MAO_DUAN_D[:5] * t ** np.arange(-2, 3)).sum(-1) \
+        + rho_h2o / 1e3 * (MAO_DUAN_D[5:] * t ** np.arange(-2, 3)).sum(-1)
+
+    return mu_rel * np.exp(log_mu)
+
+
+def brine_properties(p, T, x_nacl, rho_h2o=1000.0) -> Dict[str, np.ndarray]:
+    """Brine density [kg/m3] and viscosity [Pa s], keyed 'rhow' and 'muw' as in MATLAB."""
+    return {'rhow': brine_density(p, T, x_nacl, rho_h2o),
+            'muw': np.broadcast_to(brine_viscosity(T, x_nacl, rho_h2o),
+                                   np.broadcast(p, T, x_nacl, rho_h2o).shape)}
+
+
+def precompute_brine_properties(cases: List[Dict]) -> None:
+    """
+    Evaluate the brine properties of all cases of a sweep at once and store
+    them as `[Fluid] rhow` and `muw` of each case, which `co2lab3DPUMLE.m`
+    then uses instead of recomputing them.
+
+    Parameters
+    ----------
+    cases : List[Dict]
+        Parameters of each case (modified in place).
+    """
+    if not cases:
+        return
+    fluid = [case['Fluid'] for case in cases]
+    props = brine_properties([float(f['pres_ref']) for f in fluid], [float(f['temp_ref']) for f in fluid],
+                             [float(f['XNaCl']) for f in fluid], [float(f['rho_h2o']) for f in fluid])
+    for f, rhow, muw in zip(fluid, props['rhow'], props['muw']):
+        f['rhow'] = float(rhow)
+        f['muw'] = float(muw)
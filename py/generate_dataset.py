@@ -1,19 +1,53 @@
 import platform
 import os
+import json
 import logging
 import numpy as np
+import shutil
 import subprocess
 
+from copy import deepcopy
 from datetime import datetime
 from scipy.io import savemat
-from typing import Dict
+from typing import Callable, Dict, Iterator, List, Optional, Tuple
+
+from data_quality import DataQualityAssessment
+from dataset_store import ShardedStore
+from execution_backends import make_backend
+from fluid_properties import precompute_brine_properties
+from grid_cache import deck_digest
+from grdecl_parser import GRDECLParser
+from matlab_engine_pool import MatlabEnginePool
+from run_catalog import CATALOG_FILE, RunCatalog
+from run_metrics import (MATLAB_METRICS_FILE, METRICS_FILE, StageTimer, aggregate_metrics, clear_case_metrics,
+                         write_case_metrics)
+from stage_cache import StageCache, link_tree, stage_key
+from sweep_design import SweepDesign
+from sweep_journal import SweepJournal
+from sweep_scheduler import SweepScheduler
+from warm_start import assign_warm_starts
+from well_placement import parse_wells_list
 
 
 class GenerateDataset:
-    def __init__(self, params: Dict) -> None:
+    def __init__(self, params: Dict, prepare_grid: bool = True) -> None:
+        """Run the simulations of a setup and collect their outputs.
+
+        Parameters
+        ----------
+        params : Dict
+            Simulation parameters as returned by `ReadSimulationParams.get_params`.
+        prepare_grid : bool
+            Hash the deck and write its side-car (see `_prepare_grid`); off
+            on cluster workers, whose cases carry the grid cache key and
+            side-car path computed by the submitting host.
+        """
         self.params = params
         self.logger = self._setup_logger()
         self._validate_params()
+        self._deck_digests: Dict[Tuple[str, str], Optional[str]] = {}
+        if prepare_grid:
+            self._prepare_grid()
 
     def _setup_logger(self) -> logging.Logger:
         """Set up a logger to handle log messages."""
@@ -43,6 +77,40 @@ class GenerateDataset:
                 self.logger.error(f"Missing required parameter: {key}")
                 raise ValueError(f"Missing required parameter: {key}")
 
+    def _prepare_grid(self) -> None:
+        """
+        Prepare the grid inputs of the MATLAB run.
+
+        Tags the grid parameters with the content hash used by the MATLAB
+        grid cache (deck contents, repair flag and grid scripts) and, when
+        the grid is not cached yet, writes the binary side-car of the deck
+        so MATLAB does not parse the text deck.
+        """
+        grid = self.params.get('Grid', {})
+        if not grid.get('cache', True) or 'file_path' not in grid:
+            return
+        try:
+            # the key also changes with the grid processing scripts
+            grid['cache_key'] = stage_key('grid', {'deck': deck_digest(grid['file_path'], grid.get('repair_flag'))})
+        except OSError as e:
+            self.logger.warning(f"Grid cache disabled, failed to hash deck '{grid['file_path']}': {e}")
+            return
+        if not grid.get('cache_dir'):
+            grid['cache_dir'] = os.path.join(self.params['Paths']['PUMLE_ROOT'], 'cache')
+        self.logger.info(f"Grid cache key: {grid['cache_key']}.")
+
+        cached = os.path.isfile(os.path.join(grid['cache_dir'], f"grid_{grid['cache_key']}.mat"))
+        if not grid.get('sidecar', True) or cached:
+            return
+        sidecar_path = os.path.join(grid['cache_dir'], f"grdecl_{deck_digest(grid['file_path'], '')}.bin")
+        try:
+            if not os.path.isfile(sidecar_path):
+                self._create_directory(grid['cache_dir'])
+                GRDECLParser(grid['file_path']).write_sidecar(sidecar_path)
+            grid['sidecar_path'] = sidecar_path
+        except Exception as e:
+            self.logger.warning(f"GRDECL side-car not written, MATLAB will parse the deck: {e}")
+
     def _create_directory(self, path: str) -> None:
         """Create a directory if it does not exist."""
         try:
@@ -64,7 +132,7 @@ class GenerateDataset:
         return ini_str
 
 
-    def _print_report(self, res_dir: str, msg: bool = True) -> None:
+    def _print_report(self, res_dir: str, msg: bool = True, params: Dict = None) -> None:
         """
         Print simulation setup report for log purposes.
 
@@ -72,7 +140,9 @@ class GenerateDataset:
         ---------
             res_dir: results output directory
             msg: log message
+            params: parameters to report (defaults to the current ones)
         """
+        params = params or self.params
         out = os.path.join(self.params['Paths']['PUMLE_ROOT'], res_dir or 'temp')
         self._create_directory(out)
 
@@ -90,7 +160,7 @@ class GenerateDataset:
             f'Version: {release}\n',
             f'Hostname: {hostname}\n',
             ''.center(80, '-') + '\n',
-            self._dict_to_ini(self.params)
+            self._dict_to_ini(params)
         ]
 
         report_path = os.path.join(out, 'report.txt')
@@ -102,12 +172,31 @@ class GenerateDataset:
         except Exception as e:
             self.logger.error(f"Failed to write report: {e}")
 
-    def _export_to_matlab(self) -> None:
-        """Export dict of simulation parameters to Matlab to be read individually."""
-        mroot = os.path.join(self.params['Paths']['PUMLE_ROOT'], 'm')
+    def _case_dir(self, params: Dict) -> str:
+        """Scratch directory holding the parameter files, MATLAB log and outputs of a case."""
+        paths = params['Paths']
+        base = paths.get('scratch_dir') or os.path.join(paths['PUMLE_ROOT'], paths['PUMLE_RESULTS'], 'cases')
+        return os.path.join(base, params['Pre-Processing']['case_name'])
+
+    def _output_file(self, params: Dict) -> str:
+        """Simulation output file of a case, in its scratch directory."""
+        ext = 'json' if str(params.get('Output', {}).get('format', 'hdf5')).lower() == 'json' else 'h5'
+        return os.path.join(self._case_dir(params), f"states_{params['Pre-Processing']['case_name']}.{ext}")
+
+    def _export_to_matlab(self, params: Dict = None, out_dir: str = None) -> None:
+        """
+        Export dict of simulation parameters to Matlab to be read individually.
+
+        Parameters
+        ---------
+            params: parameters to export (defaults to the current ones)
+            out_dir: destination folder (defaults to the Matlab folder)
+        """
+        params = params or self.params
+        mroot = out_dir or os.path.join(params['Paths']['PUMLE_ROOT'], 'm')
         self._create_directory(mroot)
 
-        for section, content in self.params.items():
+        for section, content in params.items():
             basename = f"{section.replace('-', '').replace(' ', '')}ParamsPUMLE"
             fname = os.path.join(mroot, f"{basename}.mat")
             try:
@@ -116,62 +205,607 @@ class GenerateDataset:
             except Exception as e:
                 self.logger.error(f"Failed to export Matlab file '{basename}.mat': {e}")
     
-    def _run_matlab_batch(self) -> None:
-        """Run Matlab in batch mode."""
-        bin_path = self.params['MATLAB'].get('matlab')
+    def _run_matlab_batch(self, work_dir: str = None, script: str = 'co2lab3DPUMLE') -> None:
+        """
+        Run Matlab in batch mode.
+
+        Parameters
+        ---------
+            work_dir: folder holding the exported .mat files; the Matlab log
+                      is written there (defaults to the Matlab folder)
+            script: script to run; `co2lab3DBatchPUMLE` keeps the JVM,
+                    which the parallel pool needs
+        """
+        # cluster nodes may install MATLAB elsewhere: $PUMLE_MATLAB, then the
+        # configured path, then `matlab` on the PATH
+        bin_path = os.environ.get('PUMLE_MATLAB') or self.params['MATLAB'].get('matlab')
+        if not bin_path or not (os.path.isfile(bin_path) or shutil.which(bin_path)):
+            bin_path = shutil.which('matlab') or bin_path
         if not bin_path:
             self.logger.error("Path to Matlab binary is not defined.")
             raise ValueError("Path to Matlab binary is not defined.")
 
         mfile_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], 'm')
+        work_dir = work_dir or mfile_dir
 
-        # Change directory to Matlab folder
-        os.chdir(mfile_dir)
-
-        cmd = "-logfile co2lab3DPUMLE.log -nojvm -batch co2lab3DPUMLE"
+        # Matlab runs inside the working folder (no process-wide chdir), 
+        # so concurrent cases do not interfere
+        jvm = [] if script == 'co2lab3DBatchPUMLE' else ["-nojvm"]
+        cmd = [bin_path, "-logfile", os.path.join(work_dir, f"{script}.log"), *jvm,
+               "-batch", f"addpath('{mfile_dir}'); {script}"]
 
         try:
-            out = subprocess.run([bin_path] + cmd.split(), shell=False, check=True)
+            out = subprocess.run(cmd, shell=False, check=True, cwd=work_dir)
             self.logger.info(f"Matlab batch mode executed successfully with return code {out.returncode}.")
         except subprocess.CalledProcessError as e:
             self.logger.error(f"Error executing Matlab batch: {e}")
             raise
+
+    def _run_case(self, params: Dict) -> None:
+        """
+        Run one case in its own scratch directory.
+
+        Parameters
+        ---------
+            params: parameters of the case
+
+        Stage timings are written with the MATLAB metrics to `metrics.json`
+        next to `report.txt`.
+
+        Raises
+        ------
+            Exception: if any stage of the case fails.
+        """
+        case_dir = self._case_dir(params)
+        self._create_directory(case_dir)
+        params['Paths']['case_dir'] = case_dir
+        clear_case_metrics(case_dir)
+
+        timer = StageTimer()
+        status = 'failed'
+        try:
+            with timer.stage('mat_export'):
+                self._export_to_matlab(params, case_dir)
+            with timer.stage('matlab_run'):
+                self._run_matlab_batch(case_dir)
+            status = 'done'
         finally:
-            os.chdir(os.path.join(self.params['Paths']['PUMLE_ROOT'], "py"))
+            self._print_report(case_dir, msg=True, params=params)
+            self._write_metrics(case_dir, params, timer, status)
+
+    def _write_metrics(self, case_dir: str, params: Dict, timer: StageTimer, status: str) -> None:
+        """Write the metrics of a case; failures to do so do not fail the case."""
+        try:
+            write_case_metrics(case_dir, params['Pre-Processing']['case_name'], timer.stages, status)
+        except Exception as e:
+            self.logger.warning(f"Failed to write metrics of case '{params['Pre-Processing']['case_name']}': {e}")
+
+    def _catalog(self, res_dir: str) -> Optional[RunCatalog]:
+        """Run catalog of `[Execution] catalog` (relative to the results folder); None if disabled."""
+        path = self.params.get('Execution', {}).get('catalog', CATALOG_FILE)
+        return RunCatalog(os.path.join(res_dir, path)) if path else None
+
+    def _write_sweep_metrics(self, cases: List[Dict], res_dir: str) -> None:
+        """
+        Aggregate the `metrics.json` of the cases into `sweep_metrics.json`
+        and record their runs in the run catalog.
+        """
+        case_metrics = []
+        rows = []
+        for case in cases:
+            path = os.path.join(self._case_dir(case), METRICS_FILE)
+            try:
+                with open(path) as f:
+                    metrics = json.load(f)
+            except (OSError, json.JSONDecodeError):
+                continue
+            case_metrics.append(metrics)
+            rows.append(RunCatalog.case_row(case, metrics.get('status', 'failed'), metrics,
+                                            case_dir=self._case_dir(case), output_file=self._output_file(case),
+                                            report_file=os.path.join(self._case_dir(case), 'report.txt')))
+        try:
+            catalog = self._catalog(res_dir)
+            if catalog is not None:
+                with catalog:
+                    for row in rows:
+                        catalog.add(row)
+        except Exception as e:
+            self.logger.error(f"Failed to write the run catalog: {e}")
+        out = os.path.join(res_dir, 'sweep_metrics.json')
+        try:
+            with open(out, 'w') as f:
+                json.dump(aggregate_metrics(case_metrics), f, indent=2)
+            self.logger.info(f"Sweep metrics saved to '{out}'.")
+        except Exception as e:
+            self.logger.error(f"Failed to write sweep metrics: {e}")
 
     def run_simulation(self) -> None:
         """
         Run the simulation pipeline.
+
+        Raises
+        ------
+            Exception: if the simulation fails (after logging it).
         """
         try:
-            self._export_to_matlab()
-            self._run_matlab_batch()
-            self._print_report(self.params['Paths']['PUMLE_RESULTS'], msg=True)
+            self._run_case(self.params)
         except Exception as e:
             self.logger.error(f"Simulation pipeline failed: {e}")
+            raise
 
-    def run_multiple_simulations(self, n: int) -> None:
+    def _case_grid(self, n: int) -> Iterator[Tuple[str, Dict]]:
         """
-        Run multiple simulations.
+        Generate the parameters of each case of the full-factorial sweep.
+
+        Offsets in [-1, 1] are applied to the base values of `pres_ref`, 
+        `XNaCl` and `rho_h2o` (the base parameters are not modified).
 
         Parameters
         ----------
-            n: int - number of simulations to run
+            n: int - number of values per swept parameter
+
+        Yields
+        ------
+            Case label and a copy of the parameters for that case.
         """
-        self.logger.info(f"Starting {n**3} simulations.")
         param_range = np.linspace(-1, 1, n)
+        base = self.params['Fluid']
 
         for counter_1, pres_ref in enumerate(param_range):
             for counter_2, XNaCl in enumerate(param_range):
                 for counter_3, rho_h2o in enumerate(param_range):
-                    self.params['Fluid']['pres_ref'] += pres_ref
-                    self.params['Fluid']['XNaCl'] += XNaCl
-                    self.params['Fluid']['rho_h2o'] += rho_h2o
-                    self.params['Pre-Processing']['case_name'] = f"GCS01_{counter_1}_{counter_2}_{counter_3}"
-
-                    self.logger.info(f"Running simulation {counter_1}-{counter_2}-{counter_3} with pres_ref={self.params['Fluid']['pres_ref']}, XNaCl={self.params['Fluid']['XNaCl']}, rho_h2o={self.params['Fluid']['rho_h2o']}")
-                    try:
-                        self.run_simulation()
-                        self.logger.info(f"Simulation {counter_1}-{counter_2}-{counter_3} completed successfully.")
-                    except Exception as e:
-                        self.logger.error(f"Simulation {counter_1}-{counter_2}-{counter_3} failed: {e}")
+                    case = deepcopy(self.params)
+                    case.pop('Sweep', None)
+                    case['Fluid']['pres_ref'] = base['pres_ref'] + pres_ref
+                    case['Fluid']['XNaCl'] = base['XNaCl'] + XNaCl
+                    case['Fluid']['rho_h2o'] = base['rho_h2o'] + rho_h2o
+                    case['Pre-Processing']['case_name'] = f"GCS01_{counter_1}_{counter_2}_{counter_3}"
+                    yield f"{counter_1}-{counter_2}-{counter_3}", case
+
+    def run_sweep(self) -> Dict[str, str]:
+        """
+        Run the sweep declared in the `[Sweep]` section of the setup.
+
+        The case table is generated up front by the chosen sampler (LHS,
+        Sobol or full-factorial), saved as `case_table.csv` in the results
+        folder and run by the sweep scheduler.
+
+        Returns
+        -------
+            Status ('done' or 'failed') of each case, keyed by case name.
+        """
+        design = SweepDesign(self.params)
+        if not design.enabled:
+            self.logger.error("No sweep declared: set '[Sweep] sampler' and at least one parameter range.")
+            raise ValueError("No sweep declared in the setup.")
+
+        cases = design.cases()
+        res_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], self.params['Paths']['PUMLE_RESULTS'])
+        self._create_directory(res_dir)
+        design.write_case_table(cases, os.path.join(res_dir, 'case_table.csv'))
+
+        self.logger.info(f"Starting {len(cases)} simulations.")
+        return self.run_cases(cases)
+
+    def run_active_learning(self) -> Dict[str, str]:
+        """
+        Run a surrogate-guided sweep over the ranges of `[Sweep]`: batches of
+        cases chosen where a Gaussian process on the plume summary metrics
+        is most uncertain, until it reaches `[Active Learning] target_error`
+        (see `ActiveLearningSweep`).
+
+        Returns
+        -------
+            Status ('done' or 'failed') of each case, keyed by case name.
+        """
+        # scikit-learn is only needed by this sweep mode
+        from active_learning import ActiveLearningSweep
+
+        return ActiveLearningSweep(self, self.params).run()
+
+    def run_well_sweep(self, scenarios: List[str]) -> Dict[str, str]:
+        """
+        Run a well-placement/rate sweep in one MATLAB session.
+
+        The grid, fluid, model and solver are set up once and reused by
+        every scenario (`[Wells] scenarios`), so candidates do not pay the
+        grid setup cost. Scenario k of case <case> is written to
+        <case_dir>/<case>_wNNN with its own `report.txt` (with that wells
+        list) and metrics; the scenarios are listed in `well_scenarios.csv`.
+
+        Parameters
+        ----------
+            scenarios: wells list of each scenario, e.g. from
+                       `well_placement.placement_scenarios`
+
+        Returns
+        -------
+            Status ('done' or 'failed') of each scenario, keyed by case name.
+        """
+        for wells_list in scenarios:
+            parse_wells_list(wells_list)
+
+        case = deepcopy(self.params)
+        case.pop('Sweep', None)
+        case['Wells']['scenarios'] = ' | '.join(scenarios)
+        case.setdefault('Output', {})['restart'] = False
+        precompute_brine_properties([case])
+
+        base_name = case['Pre-Processing']['case_name']
+        self.logger.info(f"Starting {len(scenarios)} well scenarios of case '{base_name}' in one session.")
+        for k in range(len(scenarios)):
+            clear_case_metrics(os.path.join(self._case_dir(case), f"{base_name}_w{k:03d}"))
+        try:
+            self._run_case(case)
+        except Exception as e:
+            self.logger.error(f"Well sweep of case '{base_name}' failed: {e}")
+
+        case_dir = self._case_dir(case)
+        result = {}
+        lines = ['case_name,wells_list\n']
+        for k, wells_list in enumerate(scenarios):
+            scenario = deepcopy(case)
+            name = f"{base_name}_w{k:03d}"
+            scenario['Pre-Processing']['case_name'] = name
+            scenario['Wells']['wells_list'] = wells_list
+            scenario['Wells']['scenarios'] = ''
+            scenario_dir = os.path.join(case_dir, name)
+            scenario['Paths']['case_dir'] = scenario_dir
+
+            ext = os.path.splitext(self._output_file(case))[1]
+            status = 'done' if os.path.isfile(os.path.join(scenario_dir, f"states_{name}{ext}")) else 'failed'
+            self._print_report(scenario_dir, msg=False, params=scenario)
+            self._write_metrics(scenario_dir, scenario, StageTimer(), status)
+            result[name] = status
+            lines.append(f'{name},"{wells_list}"\n')
+
+        with open(os.path.join(case_dir, 'well_scenarios.csv'), 'w') as f:
+            f.writelines(lines)
+        self.logger.info(f"{sum(s == 'done' for s in result.values())} of {len(scenarios)} well scenarios done.")
+        return result
+
+    def run_multiple_simulations(self, n: int) -> Dict[str, str]:
+        """
+        Run multiple simulations.
+
+        Cases run concurrently (`[Execution] workers`), each in its own 
+        scratch directory. They are dispatched to a pool of warm MATLAB
+        sessions when `[MATLAB] engine_workers` is positive, and to one
+        `matlab -batch` process per case otherwise.
+
+        Parameters
+        ----------
+            n: int - number of simulations to run
+
+        Returns
+        -------
+            Status ('done' or 'failed') of each case, keyed by case name.
+        """
+        self.logger.info(f"Starting {n**3} simulations.")
+
+        cases = []
+        for label, case in self._case_grid(n):
+            self.logger.info(f"Queueing simulation {label} with pres_ref={case['Fluid']['pres_ref']}, XNaCl={case['Fluid']['XNaCl']}, rho_h2o={case['Fluid']['rho_h2o']}")
+            cases.append(case)
+        return self.run_cases(cases)
+
+    def _stage_cache(self) -> Optional[StageCache]:
+        """Cache of the stage outputs (`[Execution] stage_cache`); None if disabled."""
+        if not self.params.get('Execution', {}).get('stage_cache', True):
+            return None
+        return StageCache(os.path.join(self.params['Paths']['PUMLE_ROOT'], 'cache', 'stages'))
+
+    def _simulation_key(self, case: Dict) -> Optional[str]:
+        """
+        Content key of the simulation of a case: its parameters (not its
+        name), the contents of its deck and the MATLAB scripts. None if the
+        deck cannot be read, so the case is not cached.
+        """
+        content = deepcopy(case)
+        content['Pre-Processing'].pop('case_name', None)
+        grid = content.get('Grid', {})
+        deck = None
+        if 'file_path' in grid:
+            ident = (grid['file_path'], str(grid.get('repair_flag')))
+            if ident not in self._deck_digests:
+                try:
+                    self._deck_digests[ident] = deck_digest(grid['file_path'], grid.get('repair_flag'))
+                except OSError as e:
+                    self.logger.warning(f"Stage cache disabled, failed to hash deck '{grid['file_path']}': {e}")
+                    self._deck_digests[ident] = None
+            deck = self._deck_digests[ident]
+            if deck is None:
+                return None
+        return stage_key('simulate', {'case': SweepJournal.case_hash(content), 'deck': deck})
+
+    def _reuse_outputs(self, entry: Dict, case: Dict) -> None:
+        """
+        Link the outputs of a cached simulation into the directory of a case
+        with the same inputs, renaming them and the case name in its metrics.
+        """
+        src, dst = entry['outputs']['case_dir'], self._case_dir(case)
+        if os.path.abspath(src) == os.path.abspath(dst):
+            return
+        link_tree(src, dst)
+        old, new = entry['case_name'], case['Pre-Processing']['case_name']
+        if old != new:
+            for name in os.listdir(src):
+                if old in name:
+                    os.replace(os.path.join(dst, name), os.path.join(dst, name.replace(old, new)))
+            # metrics files are copies, not links, so they can be rewritten
+            for name in (METRICS_FILE, MATLAB_METRICS_FILE):
+                path = os.path.join(dst, name)
+                try:
+                    with open(path) as f:
+                        metrics = json.load(f)
+                except (OSError, json.JSONDecodeError):
+                    continue
+                metrics['case_name'] = new
+                if isinstance(metrics.get('matlab'), dict):
+                    metrics['matlab']['case_name'] = new
+                metrics['reused'] = old
+                with open(path, 'w') as f:
+                    json.dump(metrics, f, indent=2)
+        self._print_report(dst, msg=False, params=case)
+        self.logger.info(f"Case '{new}' reuses the outputs of '{old}' (same inputs and scripts).")
+
+    def _commit_outputs(self, cases: List[Dict], result: Dict[str, str]) -> None:
+        """Record the outputs of the cases done in the stage cache."""
+        cache = self._stage_cache()
+        if cache is None:
+            return
+        for case in cases:
+            name = case['Pre-Processing']['case_name']
+            key = self._simulation_key(case)
+            if key is not None and result.get(name) == 'done' and os.path.isfile(self._output_file(case)) \
+                    and cache.lookup('simulate', key) is None:
+                cache.commit('simulate', key, {'case_dir': self._case_dir(case),
+                                               'output_file': self._output_file(case)}, case_name=name)
+
+    def _prepare_cases(self, cases: List[Dict], res_dir: str) -> Tuple[SweepJournal, Callable[[Dict], bool]]:
+        """
+        Prepare a list of cases to run: evaluates their brine properties,
+        sets their restart flag from the sweep journal and, with `[Solver]
+        warm_start` on, their warm-start donors from the run catalog.
+
+        Returns
+        -------
+            The journal and the predicate of the cases to skip: with the
+            stage cache on, cases whose inputs and MATLAB scripts match a
+            cached simulation, whose outputs are then linked into the case
+            directory (unless the case was requeued or failed, or the cached
+            outputs failed the data-quality checks); otherwise, cases
+            journaled as done with the same parameters whose output is still
+            there.
+        """
+        # brine properties of all cases in one vectorized evaluation
+        precompute_brine_properties(cases)
+
+        journal = SweepJournal(os.path.join(res_dir, 'sweep_journal.jsonl'))
+        resume = bool(self.params.get('Execution', {}).get('resume', True))
+        for case in cases:
+            case.setdefault('Output', {})['restart'] = resume and journal.was_interrupted(case)
+
+        cache = self._stage_cache()
+
+        # Newton initial guesses from the nearest runs already in the catalog
+        solver = self.params.get('Solver', {})
+        if solver.get('warm_start', False):
+            catalog = self._catalog(res_dir)
+            if catalog is None:
+                self.logger.warning("Warm start needs the run catalog ([Execution] catalog); disabled.")
+            else:
+                with catalog:
+                    assign_warm_starts(cases, catalog, int(solver.get('warm_start_neighbours', 2)),
+                                       float(solver.get('warm_start_radius', 0.25)))
+
+        # cases whose outputs failed the data-quality checks are not reused
+        qa_failed = set()
+        if cache is not None:
+            catalog = self._catalog(res_dir)
+            if catalog is not None:
+                with catalog:
+                    qa_failed = {r['case_name'] for r in catalog.select(qa_status='failed')}
+
+        def completed(case: Dict) -> bool:
+            if not resume:
+                return False
+            if cache is None:
+                return journal.is_done(case) and os.path.isfile(self._output_file(case))
+            # requeued (e.g. by the QA) or failed cases are simulated again
+            last = journal.last(case['Pre-Processing']['case_name'])
+            if last and last['status'] in ('requeued', 'failed'):
+                return False
+            key = self._simulation_key(case)
+            entry = cache.lookup('simulate', key) if key is not None else None
+            if entry is None:
+                return False
+            donor = journal.last(entry['case_name'])
+            if entry['case_name'] in qa_failed or (donor and donor['status'] == 'requeued'):
+                cache.discard('simulate', key)
+                return False
+            self._reuse_outputs(entry, case)
+            if not journal.is_done(case):
+                journal.record(case, 'done', reused=entry['case_name'])
+            return True
+
+        return journal, completed
+
+    def run_cases(self, cases: List[Dict]) -> Dict[str, str]:
+        """
+        Run a list of cases on the execution backend (`[Execution] backend`):
+        the sweep scheduler on this node, a SLURM job array or a Dask
+        cluster, with failed cases retried `[Execution] retries` times.
+
+        Every status change is recorded in `sweep_journal.jsonl` in the
+        results folder. With `[Execution] resume` on, cases journaled as
+        done with the same parameters (and whose output is still there) are
+        skipped, and cases interrupted or failed mid-run restart from the
+        last timestep streamed to their HDF5 store. The metrics of all
+        cases are aggregated into `sweep_metrics.json`. With `[MATLAB]
+        batch` on, the cases run in one MATLAB session instead (`run_batch`).
+        """
+        if bool(self.params['MATLAB'].get('batch', False)):
+            return self.run_batch(cases, int(self.params['MATLAB'].get('batch_workers', 0)))
+
+        res_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], self.params['Paths']['PUMLE_RESULTS'])
+        status_file = os.path.join(res_dir, 'sweep_status.json')
+        self._create_directory(res_dir)
+
+        journal, completed = self._prepare_cases(cases, res_dir)
+
+        n_engines = int(self.params['MATLAB'].get('engine_workers', 0))
+        if n_engines > 0:
+            def run_on_engine(case: Dict) -> str:
+                case_dir = self._case_dir(case)
+                self._create_directory(case_dir)
+                case['Paths']['case_dir'] = case_dir
+                clear_case_metrics(case_dir)
+                timer = StageTimer()
+                with timer.stage('matlab_run'):
+                    status = pool.run_case(case)
+                self._print_report(case_dir, msg=True, params=case)
+                self._write_metrics(case_dir, case, timer, status)
+                return status
+
+            with MatlabEnginePool(self.params, n_engines) as pool:
+                scheduler = SweepScheduler(run_on_engine, workers=n_engines, journal=journal)
+                result = scheduler.run(cases, status_file, skip=completed)
+        else:
+            backend = make_backend(self.params)
+            result = backend.run(cases, self._run_case, journal, status_file, skip=completed)
+
+        self._commit_outputs(cases, result)
+        self._write_sweep_metrics(cases, res_dir)
+        self._ingest(res_dir)
+        return result
+
+    def _ingest(self, res_dir: str) -> None:
+        """
+        Add the collected outputs to the shared dataset store (`[Execution]
+        store_dir`) and check the new cases (`[Execution] qa`).
+        """
+        store_dir = self.params.get('Execution', {}).get('store_dir', '')
+        if not store_dir:
+            return
+        execution = self.params['Execution']
+        catalog = None
+        try:
+            catalog = self._catalog(res_dir)
+            store = ShardedStore(store_dir)
+            # only the runs the catalog has as done, not partial outputs of failed ones
+            done = [r['case_name'] for r in catalog.select(status='done')] if catalog is not None else None
+            added = store.ingest(res_dir, case_names=done)
+            if catalog is not None:
+                manifest = store.manifest()
+                catalog.set_ingested(manifest[name] for name in added)
+            self.logger.info(f"{len(added)} case(s) added to the dataset store '{store_dir}'.")
+        except Exception as e:
+            self.logger.error(f"Failed to ingest the results into the dataset store '{store_dir}': {e}")
+            added = []
+
+        # failed cases are requeued, so the next run of the sweep simulates them again
+        if execution.get('qa', True) and added:
+            journal = SweepJournal(os.path.join(res_dir, 'sweep_journal.jsonl'))
+            qa = DataQualityAssessment(store, journal, tol=float(execution.get('qa_tol', 1e-4)),
+                                       mass_tol=float(execution.get('qa_mass_tol', 0.05)),
+                                       max_requeues=int(execution.get('qa_max_requeues', 2)),
+                                       workers=int(execution.get('workers', 0)) or None, catalog=catalog)
+            try:
+                statuses = qa.run(added)
+                # failed outputs must not be reused by cases with the same inputs
+                cache = self._stage_cache()
+                if cache is not None:
+                    for name, status in statuses.items():
+                        if status == 'failed':
+                            cache.discard('simulate', case_name=name)
+            except Exception as e:
+                self.logger.error(f"Data-quality assessment of the dataset store '{store_dir}' failed: {e}")
+        if catalog is not None:
+            catalog.close()
+
+    def run_batch(self, cases: List[Dict], workers: int = 0) -> Dict[str, str]:
+        """
+        Run a list of cases in one MATLAB session (`co2lab3DBatchPUMLE.m`).
+
+        MRST and the grid are set up once for the whole batch and the cases
+        run in a `parfor` over the Parallel Computing Toolbox workers of the
+        session, so all cores of a node are used from a single license.
+        The cases are exported as one case table, `BatchPUMLE.mat` in
+        `<results>/batch`, instead of one set of `.mat` files per case, and
+        write their outputs to their own scratch directories. Journal and
+        resume behave as in `run_cases`.
+
+        Parameters
+        ----------
+            cases: parameters of the cases; they must share the same grid
+            workers: number of parallel workers (0 for the default pool size)
+
+        Returns
+        -------
+            Status ('done' or 'failed') of each case, keyed by case name.
+        """
+        grids = {json.dumps(case.get('Grid', {}), sort_keys=True, default=str) for case in cases}
+        if len(grids) > 1:
+            self.logger.error("All cases of a batch must share the same [Grid] settings.")
+            raise ValueError("All cases of a batch must share the same [Grid] settings.")
+
+        res_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], self.params['Paths']['PUMLE_RESULTS'])
+        batch_dir = os.path.join(res_dir, 'batch')
+        self._create_directory(batch_dir)
+        journal, completed = self._prepare_cases(cases, res_dir)
+
+        result = {case['Pre-Processing']['case_name']: 'done' for case in cases if completed(case)}
+        todo = [case for case in cases if case['Pre-Processing']['case_name'] not in result]
+        if not todo:
+            # as in run_cases, outputs not in the store yet are still ingested
+            self._write_sweep_metrics(cases, res_dir)
+            self._ingest(res_dir)
+            return result
+
+        timer = StageTimer()
+        with timer.stage('mat_export'):
+            table = np.empty(len(todo), dtype=object)
+            for k, case in enumerate(todo):
+                case_dir = self._case_dir(case)
+                self._create_directory(case_dir)
+                case['Paths']['case_dir'] = case_dir
+                clear_case_metrics(case_dir)
+                table[k] = MatlabEnginePool._to_matlab(case)
+                journal.record(case, 'running')
+            savemat(os.path.join(batch_dir, 'BatchPUMLE.mat'), {'cases': table, 'workers': float(workers)})
+
+        # statuses of a previous batch must not be taken for the ones of this one
+        status_path = os.path.join(batch_dir, 'batch_status.json')
+        if os.path.exists(status_path):
+            os.remove(status_path)
+
+        self.logger.info(f"Starting a batch of {len(todo)} case(s) in one MATLAB session.")
+        try:
+            with timer.stage('matlab_run'):
+                self._run_matlab_batch(batch_dir, script='co2lab3DBatchPUMLE')
+        except Exception as e:
+            self.logger.error(f"Batch failed: {e}")
+
+        try:
+            with open(status_path) as f:
+                records = json.load(f)
+            records = records if isinstance(records, list) else [records]
+        except (OSError, json.JSONDecodeError):
+            records = []
+        batch_status = {r['case_name']: r for r in records}
+
+        for case in todo:
+            name = case['Pre-Processing']['case_name']
+            record = batch_status.get(name, {})
+            status = record.get('status', 'failed')
+            journal.record(case, status, **({'error': record['message']} if record.get('message') else {}))
+            self._print_report(case['Paths']['case_dir'], msg=False, params=case)
+            self._write_metrics(case['Paths']['case_dir'], case, timer, status)
+            result[name] = status
+
+        self._commit_outputs(cases, result)
+        self._write_sweep_metrics(cases, res_dir)
+        self._ingest(res_dir)
+        self.logger.info(f"Batch completed: {sum(s == 'done' for s in result.values())} of {len(cases)} case(s) done.")
+        return result
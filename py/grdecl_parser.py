@@ -0,0 +1,248 @@
+import os
+import re
+import mmap
+import json
+import logging
+import numpy as np
+
+from concurrent.futures import ProcessPoolExecutor
+from typing import Dict, List, Optional, Tuple
+
+
+# Keywords kept from the GRID section (those used by processGRDECL and grdecl2Rock)
+ARRAY_KEYWORDS = {
+    'COORD': np.float64, 'ZCORN': np.float64, 'ACTNUM': np.int32,
+    'PORO': np.float64, 'NTG': np.float64,
+    'PERMX': np.float64, 'PERMY': np.float64, 'PERMZ': np.float64,
+}
+SECTION_KEYWORDS = {'RUNSPEC', 'GRID', 'EDIT', 'PROPS', 'REGIONS', 'SOLUTION', 'SUMMARY', 'SCHEDULE'}
+
+KEYWORD_PATTERN = re.compile(rb"^([A-Z][A-Z0-9_+-]{0,7})[ \t]*(?:--[^\n]*)?\r?$", re.MULTILINE)
+COMMENT_PATTERN = re.compile(rb"--[^\n]*")
+INCLUDE_PATTERN = re.compile(rb"\s*(?:'([^']+)'|([^\s/]+))\s*/")
+RECORD_END_PATTERN = re.compile(rb"^\s*/", re.MULTILINE)
+
+SIDECAR_MAGIC = b"PUMLEGRD"
+SIDECAR_ALIGN = 64
+
+# Byte size of the numeric blocks handed to each worker process
+CHUNK_BYTES = 1 << 22
+
+
+def _parse_values(data: bytes) -> np.ndarray:
+    """Parse a whitespace separated block of numbers, expanding `n*value` repeats."""
+    data = COMMENT_PATTERN.sub(b'', data)
+    if b'*' not in data:
+        return np.array(data.split(), dtype=np.float64)
+
+    tokens = np.array(data.split())
+    star = np.char.find(tokens, b'*') >= 0
+    parts = np.char.partition(tokens[star], b'*')
+
+    counts = np.ones(tokens.size, dtype=np.int64)
+    counts[star] = parts[:, 0].astype(np.int64)
+
+    values = np.empty(tokens.size, dtype=np.float64)
+    values[~star] = tokens[~star].astype(np.float64)
+    values[star] = np.where(parts[:, 2] == b'', b'nan', parts[:, 2]).astype(np.float64)
+    return np.repeat(values, counts)
+
+
+def _parse_chunk(path: str, start: int, end: int) -> np.ndarray:
+    """Worker: parse bytes [start, end) of a memory-mapped deck file."""
+    with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+        return _parse_values(mm[start:end])
+
+
+def _split_block(mm: mmap.mmap, start: int, end: int) -> List[Tuple[int, int]]:
+    """Split a byte range at line boundaries into pieces of about CHUNK_BYTES."""
+    pieces = []
+    while end - start > CHUNK_BYTES:
+        cut = mm.find(b'\n', start + CHUNK_BYTES, end)
+        if cut < 0:
+            break
+        pieces.append((start, cut))
+        start = cut
+    pieces.append((start, end))
+    return pieces
+
+
+class GRDECLParser:
+    def __init__(self, file_path: str, workers: Optional[int] = None) -> None:
+        """Streaming parser for the grid keywords of an ECLIPSE/GRDECL deck.
+
+        The deck (and its INCLUDE files) is memory-mapped and split on
+        keywords. Numeric blocks are cut into line-aligned chunks that are
+        parsed in parallel by worker processes.
+
+        Parameters
+        ----------
+        file_path : str
+            Path to the main deck file.
+        workers : int, optional
+            Number of worker processes (defaults to the number of cores).
+        """
+        self.file_path = os.path.abspath(file_path)
+        self.workers = workers or os.cpu_count() or 1
+        self.logger = logging.getLogger("PUMLELogger")
+
+    def _scan(self, path: str, section: str, blocks: List, ops: List, dims: Dict) -> str:
+        """Locate keyword blocks of one file; recurse into INCLUDE files."""
+        with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            pos = 0
+            while True:
+                match = KEYWORD_PATTERN.search(mm, pos)
+                if match is None:
+                    break
+                kw = match.group(1).decode()
+                pos = match.end()
+
+                if kw in SECTION_KEYWORDS:
+                    section = kw
+                    continue
+
+                if kw == 'INCLUDE' and section not in ('SUMMARY', 'SCHEDULE'):
+                    inc = INCLUDE_PATTERN.match(mm, pos)
+                    if inc is None:
+                        raise ValueError(f"Malformed INCLUDE in '{path}'.")
+                    pos = inc.end()
+                    inc_path = os.path.join(os.path.dirname(path), (inc.group(1) or inc.group(2)).decode())
+                    if os.path.isfile(inc_path):
+                        section = self._scan(inc_path, section, blocks, ops, dims)
+                    else:
+                        self.logger.warning(f"INCLUDE file '{inc_path}' not found; skipped.")
+                    continue
+
+                if kw == 'MULTIPLY' and section == 'GRID':
+                    end = RECORD_END_PATTERN.search(mm, pos)
+                    if end is None:
+                        raise ValueError(f"Keyword 'MULTIPLY' in '{path}' is not terminated by '/'.")
+                    ops.append(COMMENT_PATTERN.sub(b'', mm[pos:end.start()]).decode())
+                    pos = end.end()
+                    continue
+
+                if kw in ('DIMENS', 'SPECGRID') or (section == 'GRID' and kw in ARRAY_KEYWORDS):
+                    stop = mm.find(b'/', pos)
+                    if stop < 0:
+                        raise ValueError(f"Keyword '{kw}' in '{path}' is not terminated by '/'.")
+                    if kw in ('DIMENS', 'SPECGRID'):
+                        dims['cartDims'] = [int(v) for v in COMMENT_PATTERN.sub(b'', mm[pos:stop]).split()[:3]]
+                    else:
+                        blocks.append((kw, path, _split_block(mm, pos, stop)))
+                    pos = stop + 1
+        return section
+
+    @staticmethod
+    def _apply_multiply(arrays: Dict[str, np.ndarray], ops: List[str], cart_dims: List[int]) -> None:
+        """Apply MULTIPLY records (`ARRAY factor [i1 i2 j1 j2 k1 k2] /`)."""
+        nx, ny, nz = cart_dims
+        for op in ops:
+            for record in op.split('/'):
+                fields = record.split()
+                if len(fields) < 2 or fields[0] not in arrays:
+                    continue
+                name, factor = fields[0], float(fields[1])
+                box = [int(v) for v in fields[2:8]] if len(fields) >= 8 else [1, nx, 1, ny, 1, nz]
+                view = arrays[name].reshape((nx, ny, nz), order='F')
+                view[box[0] - 1:box[1], box[2] - 1:box[3], box[4] - 1:box[5]] *= factor
+
+    def parse(self) -> Dict[str, np.ndarray]:
+        """
+        Parse the grid keywords of the deck.
+
+        Returns
+        -------
+        Dict[str, np.ndarray]
+            Keyword arrays plus `cartDims`.
+        """
+        blocks, ops, dims = [], [], {}
+        self._scan(self.file_path, 'RUNSPEC', blocks, ops, dims)
+        if 'cartDims' not in dims:
+            raise ValueError(f"No DIMENS/SPECGRID found in '{self.file_path}'.")
+
+        with ProcessPoolExecutor(max_workers=self.workers) as executor:
+            futures = [[executor.submit(_parse_chunk, path, s, e) for s, e in pieces]
+                       for _, path, pieces in blocks]
+            arrays = {}
+            for (kw, _, _), fut in zip(blocks, futures):
+                if kw in arrays:
+                    self.logger.warning(f"Keyword '{kw}' defined more than once; keeping the last one.")
+                arrays[kw] = np.concatenate([f.result() for f in fut]).astype(ARRAY_KEYWORDS[kw])
+
+        self._apply_multiply(arrays, ops, dims['cartDims'])
+        arrays['cartDims'] = np.array(dims['cartDims'], dtype=np.int32)
+        self.logger.info(f"Parsed {len(blocks)} keyword blocks from '{self.file_path}'.")
+        return arrays
+
+    def write_sidecar(self, sidecar_path: str) -> str:
+        """
+        Parse the deck and write its arrays into a binary side-car file.
+
+        Layout: 8-byte magic, little-endian uint64 header length, JSON
+        header, then each array raw and little-endian at a 64-byte aligned
+        offset given in the header, so readers can map it directly.
+
+        Parameters
+        ----------
+        sidecar_path : str
+            Output file path.
+
+        Returns
+        -------
+        str
+            The side-car file path.
+        """
+        arrays = self.parse()
+
+        header = {'version': 1, 'source': self.file_path, 'arrays': {}}
+        offset = 0
+        for name, arr in arrays.items():
+            header['arrays'][name] = {'dtype': arr.dtype.name, 'count': int(arr.size), 'offset': offset}
+            offset += -(-arr.nbytes // SIDECAR_ALIGN) * SIDECAR_ALIGN
+
+        # Array offsets are relative to the end of the header; leave room for
+        # the digits they gain once made absolute
+        raw = json.dumps(header).encode()
+        data_start = -(-(len(SIDECAR_MAGIC) + 8 + len(raw) + 1024) // SIDECAR_ALIGN) * SIDECAR_ALIGN
+        for meta in header['arrays'].values():
+            meta['offset'] += data_start
+        raw = json.dumps(header).encode()
+        raw += b' ' * (data_start - len(SIDECAR_MAGIC) - 8 - len(raw))
+
+        tmp_path = f"{sidecar_path}.{os.getpid()}.tmp"
+        with open(tmp_path, 'wb') as f:
+            f.write(SIDECAR_MAGIC)
+            f.write(np.uint64(len(raw)).tobytes())
+            f.write(raw)
+            for name, arr in arrays.items():
+                f.seek(header['arrays'][name]['offset'])
+                f.write(arr.astype(arr.dtype.newbyteorder('<'), copy=False).tobytes())
+        os.replace(tmp_path, sidecar_path)
+
+        self.logger.info(f"GRDECL side-car written to '{sidecar_path}'.")
+        return sidecar_path
+
+
+def load_sidecar(sidecar_path: str) -> Dict[str, np.ndarray]:
+    """
+    Map the arrays of a side-car file without copying them.
+
+    Parameters
+    ----------
+    sidecar_path : str
+        Path written by `GRDECLParser.write_sidecar`.
+
+    Returns
+    -------
+    Dict[str, np.ndarray]
+        Read-only memory-mapped arrays keyed by keyword.
+    """
+    with open(sidecar_path, 'rb') as f:
+        if f.read(len(SIDECAR_MAGIC)) != SIDECAR_MAGIC:
+            raise ValueError(f"'{sidecar_path}' is not a PUMLE GRDECL side-car file.")
+        size = int(np.frombuffer(f.read(8), dtype='<u8')[0])
+        header = json.loads(f.read(size))
+
+    return {name: np.memmap(sidecar_path, dtype=np.dtype(meta['dtype']).newbyteorder('<'), mode='r',
+                            offset=meta['offset'], shape=(meta['count'],))
+            for name, meta in header['arrays'].items()}
@@ -0,0 +1,62 @@
+import os
+import re
+import hashlib
+
+from typing import List
+
+
+INCLUDE_PATTERN = re.compile(rb"^\s*INCLUDE\s*(?:--[^\n]*)?\n\s*'?([^'\s/]+)'?\s*/", re.MULTILINE)
+
+
+def deck_files(file_path: str) -> List[str]:
+    """
+    List a deck file and, recursively, the files it pulls in with INCLUDE.
+
+    Parameters
+    ----------
+        file_path: path to the main deck (.DATA/.GRDECL) file
+
+    Returns
+    -------
+        Paths of the deck files, main file first.
+    """
+    files, pending = [], [os.path.abspath(file_path)]
+    while pending:
+        path = pending.pop(0)
+        if path in files:
+            continue
+        files.append(path)
+        with open(path, 'rb') as f:
+            content = f.read()
+        base = os.path.dirname(path)
+        for inc in INCLUDE_PATTERN.findall(content):
+            inc_path = os.path.join(base, inc.decode())
+            if os.path.isfile(inc_path):
+                pending.append(inc_path)
+    return files
+
+
+def deck_digest(file_path: str, repair_flag) -> str:
+    """
+    Content hash identifying a processed grid.
+
+    The key depends on the contents of the deck (and its includes) and on
+    the ZCORN repair flag, so that renaming or moving the deck does not
+    invalidate the cache.
+
+    Parameters
+    ----------
+        file_path: path to the main deck file
+        repair_flag: value of `[Grid] repair_flag`
+
+    Returns
+    -------
+        Hex digest (SHA-256, truncated to 32 characters).
+    """
+    h = hashlib.sha256()
+    for path in deck_files(file_path):
+        with open(path, 'rb') as f:
+            for block in iter(lambda: f.read(1 << 20), b''):
+                h.update(block)
+    h.update(str(repair_flag).strip().lower().encode())
+    return h.hexdigest()[:32]
@@ -0,0 +1,169 @@
+import io
+import os
+import queue
+import logging
+import threading
+
+from concurrent.futures import ThreadPoolExecutor
+from typing import Dict, List
+
+
+class MatlabEnginePool:
+    def __init__(self, params: Dict, n_workers: int) -> None:
+        """Keep N warm MATLAB sessions with MRST loaded to run simulations.
+
+        Parameters
+        ----------
+        params : Dict
+            Simulation parameters as returned by `ReadSimulationParams.get_params`.
+        n_workers : int
+            Number of MATLAB sessions to keep alive.
+        """
+        self.params = params
+        self.n_workers = max(1, int(n_workers))
+        self.logger = logging.getLogger("PUMLELogger")
+        self.mfile_dir = os.path.join(self.params['Paths']['PUMLE_ROOT'], 'm')
+        self._engines = queue.Queue()
+        # healthy sessions, in the queue or running a case
+        self._alive = 0
+        self._lock = threading.Lock()
+
+    def __enter__(self) -> "MatlabEnginePool":
+        self.start()
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def _start_engine(self):
+        """Start one MATLAB session and load MRST into it."""
+        import matlab.engine
+
+        eng = matlab.engine.start_matlab("-nojvm")
+        eng.run(os.path.join(self.params['MATLAB']['mrst_root'], 'startup.m'), nargout=0)
+        eng.eval("mrstModule add co2lab ad-core ad-props ad-blackoil; mrstVerbose off", nargout=0)
+        eng.addpath(self.mfile_dir, nargout=0)
+        return eng
+
+    def start(self) -> None:
+        """Start all MATLAB sessions concurrently."""
+        self.logger.info(f"Starting {self.n_workers} MATLAB engine worker(s).")
+        try:
+            with ThreadPoolExecutor(max_workers=self.n_workers) as executor:
+                for eng in executor.map(lambda _: self._start_engine(), range(self.n_workers)):
+                    self._engines.put(eng)
+                    with self._lock:
+                        self._alive += 1
+        except Exception as e:
+            self.logger.error(f"Failed to start MATLAB engine pool: {e}")
+            self.close()
+            raise
+        self.logger.info("MATLAB engine pool is ready.")
+
+    def close(self) -> None:
+        """Shut down all MATLAB sessions."""
+        while not self._engines.empty():
+            eng = self._engines.get_nowait()
+            with self._lock:
+                self._alive -= 1
+            try:
+                eng.quit()
+            except Exception as e:
+                self.logger.warning(f"Failed to quit MATLAB engine: {e}")
+
+    @staticmethod
+    def _to_matlab(params: Dict) -> Dict:
+        """Convert the parameter dict into the PARAMS struct layout used by `co2lab3DPUMLE.m`."""
+        out = {}
+        for section, content in params.items():
+            name = section.replace('-', '').replace(' ', '')
+            out[name] = {k: float(v) if isinstance(v, (int, float)) and not isinstance(v, bool) else v
+                         for k, v in content.items()}
+        return out
+
+    def _acquire(self):
+        """Next free MATLAB session; raises once no healthy session is left."""
+        while True:
+            with self._lock:
+                if self._alive <= 0:
+                    raise RuntimeError("No healthy MATLAB engine left in the pool.")
+            try:
+                return self._engines.get(timeout=1)
+            except queue.Empty:
+                continue
+
+    def run_case(self, params: Dict) -> str:
+        """Run one simulation on the next free MATLAB session.
+
+        A session that dies is restarted; if that fails, it is dropped and
+        the pool shrinks.
+
+        Parameters
+        ----------
+        params : Dict
+            Parameters of the case to run.
+
+        Returns
+        -------
+        str
+            Completion status: 'done' or 'failed'.
+
+        Raises
+        ------
+        RuntimeError
+            If no healthy MATLAB session is left.
+        """
+        import matlab.engine
+
+        case_name = params['Pre-Processing']['case_name']
+        eng = self._acquire()
+        out, err = io.StringIO(), io.StringIO()
+        status = 'failed'
+        try:
+            eng.cd(params['Paths'].get('case_dir', self.mfile_dir), nargout=0)
+            eng.workspace['PARAMS'] = self._to_matlab(params)
+            eng.co2lab3DPUMLE(nargout=0, stdout=out, stderr=err)
+            status = 'done'
+            self.logger.info(f"Case '{case_name}' completed on MATLAB engine.")
+        except matlab.engine.EngineError as e:
+            self.logger.error(f"MATLAB engine died while running case '{case_name}': {e}. Restarting it.")
+            try:
+                eng = self._start_engine()
+            except Exception as e:
+                eng = None
+                with self._lock:
+                    self._alive -= 1
+                    alive = self._alive
+                self.logger.error(f"Failed to restart MATLAB engine: {e}. {alive} engine(s) left in the pool.")
+        except Exception as e:
+            self.logger.error(f"Case '{case_name}' failed on MATLAB engine: {e}")
+        finally:
+            if eng is not None:
+                try:
+                    eng.eval("clearvars", nargout=0)
+                except Exception:
+                    pass
+                self._engines.put(eng)
+            self._write_log(params, out.getvalue() + err.getvalue())
+        return status
+
+    def _write_log(self, params: Dict, text: str) -> None:
+        """Save the MATLAB console output of a case, as `-logfile` does in batch mode."""
+        log_file = os.path.join(params['Paths'].get('case_dir', self.mfile_dir), "co2lab3DPUMLE.log")
+        try:
+            with open(log_file, 'w') as f:
+                f.write(text)
+        except Exception as e:
+            self.logger.warning(f"Failed to write MATLAB log '{log_file}': {e}")
+
+    def run_cases(self, cases: List[Dict]) -> Dict[str, str]:
+        """Run a list of cases across the pool.
+
+        Returns
+        -------
+        Dict[str, str]
+            Status of each case, keyed by case name, in submission order.
+        """
+        with ThreadPoolExecutor(max_workers=self.n_workers) as executor:
+            statuses = list(executor.map(self.run_case, cases))
+        return {c['Pre-Processing']['case_name']: s for c, s in zip(cases, statuses)}
@@ -37,6 +37,12 @@ class ReadSimulationParams:
             self.logger.error(f"Configuration file '{self.config_file}' not found.")
             raise FileNotFoundError(f"Configuration file '{self.config_file}' not found.")
 
+    @staticmethod
+    def _cast(value, default):
+        """Cast a raw option value to the type of its default."""
+        if isinstance(default, bool):
+            return str(value).strip().lower() in ('true', '1', 'yes', 'on')
+        return type(default)(value)
 
     def get_params(self) -> Dict:
         """
@@ -51,7 +57,8 @@ class ReadSimulationParams:
         config.read(self.config_file)
 
         sections = ['Paths', 'Pre-Processing', 'Grid', 'Fluid', 'Initial Conditions',
-                    'Boundary Conditions', 'Wells', 'Schedule', 'MATLAB']
+                    'Boundary Conditions', 'Wells', 'Schedule', 'MATLAB', 'Output', 'Solver', 'Execution',
+                    'Active Learning']
 
         PARAMS = {}
 
@@ -63,18 +70,50 @@ class ReadSimulationParams:
             'Fluid': (['pres_ref', 'temp_ref', 'cp_rock', 'srw', 'src', 'pe', 'XNaCl', 'rho_h2o'], True),
             'Initial Conditions': (['sw_0'], True),
             'Boundary Conditions': (['type'], False),
-            'Wells': (['CO2_inj'], False),
-            'Schedule': (['injection_time', 'migration_time', 'injection_timestep_rampup', 'migration_timestep'], True),
+            'Wells': (['CO2_inj'], True),
+            'Schedule': (['injection_time', 'migration_time', 'injection_timesteps', 'migration_timesteps'], True),
             'MATLAB': (['matlab', 'mrst_root'], False),
+            'Output': ([], False),
+            'Solver': ([], False),
+            'Execution': ([], False),
+            'Active Learning': ([], False),
+        }
+
+        # Optional parameters: read when present, otherwise set to their defaults.
+        # Values are cast to the type of the default.
+        optional_definitions = {
+            'Paths': {'scratch_dir': ''},
+            'Pre-Processing': {'model_type': '3d'},
+            'Wells': {'wells_list': '', 'scenarios': ''},
+            'Fluid': {'pressure_tables': False, 'table_points': 200, 'table_pmin': 0.0, 'table_pmax': 0.0},
+            'Grid': {'cache': True, 'cache_dir': '', 'sidecar': True, 'coarsen': '1, 1, 1'},
+            'Schedule': {'mode': 'uniform', 'rampup_steps': 5, 'selector': 'iterations',
+                         'target_iterations': 5, 'target_ds': 0.2, 'max_timestep_cuts': 6},
+            'MATLAB': {'engine_workers': 0, 'batch': False, 'batch_workers': 0},
+            'Output': {'format': 'hdf5', 'compression': 1, 'summary': True, 'fields': True, 'plume_threshold': 0.01,
+                       'quantize': False, 'delta': False, 'sparse': False, 'sparse_eps': 1e-6,
+                       'keyframe_interval': 10},
+            'Solver': {'linear_solver': 'cpr', 'amgcl': True, 'linear_tolerance': 1e-4,
+                       'linear_max_iterations': 100, 'tolerance_cnv': 1e-3, 'tolerance_mb': 1e-7,
+                       'max_iterations': 25, 'threads': 0, 'warm_start': False, 'warm_start_neighbours': 2,
+                       'warm_start_radius': 0.25},
+            'Execution': {'workers': 0, 'memory_per_case': 4.0, 'resume': True, 'backend': 'local',
+                          'retries': 0, 'node_scratch': '', 'store_dir': '', 'slurm_tasks': 0,
+                          'slurm_concurrency': 0, 'slurm_options': '', 'dask_address': '', 'qa': True,
+                          'qa_tol': 1e-4, 'qa_mass_tol': 0.05, 'qa_max_requeues': 2,
+                          'catalog': 'run_catalog.sqlite', 'stage_cache': True},
+            'Active Learning': {'enabled': False, 'initial_samples': 8, 'batch_size': 4, 'max_cases': 64,
+                                'target_error': 0.05, 'metrics': 'co2_mass, footprint_area, max_dp',
+                                'candidates': 2048},
         }
 
         for section, (params, cast_to_float) in param_definitions.items():
+            section_params = {}
             if not config.has_section(section):
-                self.logger.warning(f"Missing section: {section}")
-                PARAMS[section] = {}
-                continue
+                if params:
+                    self.logger.warning(f"Missing section: {section}")
+                params = []
 
-            section_params = {}
             for param in params:
                 try:
                     value = config.get(section, param)
@@ -83,8 +122,18 @@ class ReadSimulationParams:
                     section_params[param] = value
                 except (configparser.NoOptionError, ValueError) as e:
                     self.logger.error(f"Error reading parameter '{param}' from section '{section}': {e}")
+            for param, default in optional_definitions.get(section, {}).items():
+                try:
+                    section_params[param] = self._cast(config.get(section, param, fallback=default), default)
+                except ValueError as e:
+                    self.logger.error(f"Error reading parameter '{param}' from section '{section}': {e}")
+                    section_params[param] = default
             PARAMS[section] = section_params
 
+        # Sweep ranges are free-form ('<parameter> = min, max'); see SweepDesign
+        if config.has_section('Sweep'):
+            PARAMS['Sweep'] = {k: v for k, v in config.items('Sweep')}
+
         self.logger.info("Simulation parameters successfully read.")
         return PARAMS
 
@@ -0,0 +1,19 @@
+import os
+import sys
+
+from benchmark import PUMLE_ROOT, PUMLEBenchmark
+
+
+BENCHMARK_CONFIG = os.path.join(PUMLE_ROOT, "benchmark", "benchmark.ini")
+
+if __name__ == "__main__":
+    # Reference cases and concurrency levels from the benchmark configuration
+    config_file = sys.argv[1] if len(sys.argv) > 1 else BENCHMARK_CONFIG
+
+    # Run all levels; results go to benchmark/results (JSON + history.jsonl)
+    results = PUMLEBenchmark(config_file).run()
+
+    for level in results['levels']:
+        ingestion = level['ingestion'].get('mb_per_s', float('nan'))
+        print(f"concurrency {level['concurrency']}: {level['done']}/{level['cases']} cases, "
+              f"{level['simulations_per_hour']:.1f} simulations/h, ingestion {ingestion:.1f} MB/s")
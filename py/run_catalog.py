@@ -0,0 +1,225 @@
+import os
+import json
+import sqlite3
+import logging
+import threading
+
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple
+
+from run_metrics import numeric_leaves
+from sweep_journal import UNHASHED_SECTIONS, SweepJournal
+
+
+CATALOG_FILE = 'run_catalog.sqlite'
+
+# Fixed columns of the runs table; parameters ('Section.key') and numeric
+# metrics ('matlab.stages.simulate', ...) are added as columns when first seen
+RUN_COLUMNS = {
+    'run_id': 'INTEGER PRIMARY KEY AUTOINCREMENT',
+    'case_name': 'TEXT NOT NULL',
+    'case_hash': 'TEXT',
+    'status': 'TEXT',
+    'host': 'TEXT',
+    'finished': 'TEXT',
+    'fidelity': 'TEXT',
+    'case_dir': 'TEXT',
+    'output_file': 'TEXT',
+    'report_file': 'TEXT',
+    'error': 'TEXT',
+    'shard': 'TEXT',
+    'shard_offset': 'INTEGER',
+    'qa_status': 'TEXT',
+    'qa_checks': 'TEXT',
+}
+
+
+def _quote(column: str) -> str:
+    return '"' + column.replace('"', '""') + '"'
+
+
+class RunCatalog:
+    def __init__(self, path: str, batch_size: int = 256) -> None:
+        """SQLite catalog of the runs of all sweeps (`[Execution] catalog`).
+
+        One row per run of a case: case name and parameter hash, status,
+        host, completion time, output locations, one column per input
+        parameter ('Section.key') and per numeric metric of `metrics.json`
+        (stage timings, solver statistics, memory), and, once ingested and
+        checked, the shard and QA status of the case. Runs are inserted in
+        batches of `batch_size` in one transaction; the view `latest_runs`
+        keeps the last run of each case. The database is in WAL mode, so it
+        can be queried while a sweep writes to it.
+
+        Example::
+
+            catalog.select(status='done', ranges={'Fluid.XNaCl': (0.15, 1.0)})
+            catalog.query('SELECT case_name FROM latest_runs WHERE "Fluid.XNaCl" > ?', (0.15,))
+
+        Parameters
+        ----------
+        path : str
+            Database file (created if needed).
+        batch_size : int
+            Number of buffered runs that triggers an insert.
+        """
+        self.path = path
+        self.batch_size = batch_size
+        self.logger = logging.getLogger("PUMLELogger")
+        self._lock = threading.Lock()
+        self._pending: List[Dict] = []
+
+        os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+        self._conn = sqlite3.connect(path, timeout=30, check_same_thread=False)
+        self._conn.row_factory = sqlite3.Row
+        self._conn.execute('PRAGMA journal_mode=WAL')
+        self._conn.execute('PRAGMA synchronous=NORMAL')
+        with self._conn:
+            columns = ', '.join(f"{name} {kind}" for name, kind in RUN_COLUMNS.items())
+            self._conn.execute(f"CREATE TABLE IF NOT EXISTS runs ({columns}, "
+                               f"UNIQUE (case_name, case_hash, finished))")
+            self._conn.execute("CREATE INDEX IF NOT EXISTS runs_case ON runs (case_name)")
+            self._conn.execute("CREATE INDEX IF NOT EXISTS runs_status ON runs (status)")
+            self._conn.execute("CREATE VIEW IF NOT EXISTS latest_runs AS SELECT * FROM runs "
+                               "WHERE run_id IN (SELECT MAX(run_id) FROM runs GROUP BY case_name)")
+        self._columns = self._table_columns()
+
+    def __enter__(self) -> 'RunCatalog':
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def close(self) -> None:
+        self.flush()
+        self._conn.close()
+
+    def _table_columns(self) -> Dict[str, str]:
+        return {row['name']: row['type'] for row in self._conn.execute("PRAGMA table_info(runs)")}
+
+    @staticmethod
+    def case_row(case: Dict, status: str, metrics: Optional[Dict] = None, **extra) -> Dict:
+        """
+        Catalog row of one run from its parameters and its `metrics.json`.
+
+        Parameters
+        ----------
+        case : Dict
+            Parameters of the case.
+        status : str
+            Completion status of the run.
+        metrics : Dict, optional
+            Metrics of the run (see `write_case_metrics`).
+        extra :
+            Other columns, e.g. case_dir, output_file.
+        """
+        metrics = metrics or {}
+        row = {'case_name': case['Pre-Processing']['case_name'], 'case_hash': SweepJournal.case_hash(case),
+               'status': status, 'host': metrics.get('host'), 'finished': metrics.get('finished'), **extra}
+        for section, content in case.items():
+            if section in UNHASHED_SECTIONS or not isinstance(content, dict):
+                continue
+            for key, value in content.items():
+                row[f"{section}.{key}"] = value if isinstance(value, (int, float, str)) else json.dumps(value)
+        row.update(numeric_leaves({k: v for k, v in metrics.items() if isinstance(v, dict)}))
+        return row
+
+    def add(self, row: Dict) -> None:
+        """Buffer a run; the buffer is written once it holds `batch_size` runs."""
+        with self._lock:
+            self._pending.append(row)
+            full = len(self._pending) >= self.batch_size
+        if full:
+            self.flush()
+
+    def _add_columns(self, rows: Iterable[Dict]) -> None:
+        new = {}
+        for row in rows:
+            for key, value in row.items():
+                if key not in self._columns and key not in new:
+                    new[key] = 'REAL' if isinstance(value, (int, float)) and not isinstance(value, bool) else 'TEXT'
+        for key, kind in new.items():
+            self._conn.execute(f"ALTER TABLE runs ADD COLUMN {_quote(key)} {kind}")
+            self._columns[key] = kind
+
+    def flush(self) -> None:
+        """Write the buffered runs in one transaction (runs already cataloged are ignored)."""
+        with self._lock:
+            rows, self._pending = self._pending, []
+        if not rows:
+            return
+        with self._lock, self._conn:
+            self._add_columns(rows)
+            groups: Dict[Tuple[str, ...], List[Tuple]] = {}
+            for row in rows:
+                groups.setdefault(tuple(row), []).append(tuple(row.values()))
+            for keys, values in groups.items():
+                self._conn.executemany(f"INSERT OR IGNORE INTO runs ({', '.join(map(_quote, keys))}) "
+                                       f"VALUES ({', '.join('?' * len(keys))})", values)
+        self.logger.info(f"{len(rows)} run(s) written to the run catalog '{self.path}'.")
+
+    def _update_latest(self, values: Sequence[Tuple], columns: Sequence[str]) -> None:
+        """Update columns of the last run of each case; `values` rows end with the case name."""
+        if not values:
+            return
+        assignments = ', '.join(f"{_quote(c)} = ?" for c in columns)
+        with self._lock, self._conn:
+            self._conn.executemany(f"UPDATE runs SET {assignments} WHERE run_id = "
+                                   f"(SELECT MAX(run_id) FROM runs WHERE case_name = ?)", values)
+
+    def set_ingested(self, records: Iterable[Dict]) -> None:
+        """Record the shard and row of ingested cases (`ShardedStore` case records)."""
+        self.flush()
+        self._update_latest([(r['shard'], r['offset'], r.get('fidelity'), r['case_name']) for r in records],
+                            ('shard', 'shard_offset', 'fidelity'))
+
+    def set_qa(self, results: Iterable[Dict]) -> None:
+        """Record the data-quality status of checked cases (`DataQualityAssessment` results)."""
+        self.flush()
+        self._update_latest([(r['status'], json.dumps(r.get('checks', {})), r['case_name']) for r in results],
+                            ('qa_status', 'qa_checks'))
+
+    def query(self, sql: str, args: Sequence = ()) -> List[Dict]:
+        """Run a SQL query on the catalog (tables `runs` and `latest_runs`)."""
+        self.flush()
+        with self._lock:
+            return [dict(row) for row in self._conn.execute(sql, tuple(args))]
+
+    def select(self, status: Optional[str] = None, ranges: Optional[Dict[str, Tuple[float, float]]] = None,
+               latest: bool = True, **equals) -> List[Dict]:
+        """
+        Select runs by status and parameter values.
+
+        Parameters
+        ----------
+        status : str, optional
+            Run status, e.g. 'done'.
+        ranges : Dict[str, Tuple[float, float]], optional
+            Closed intervals keyed by column, e.g. {'Fluid.XNaCl': (0.15, 1.0)}.
+        latest : bool
+            Only the last run of each case.
+        equals :
+            Exact matches on other columns, e.g. qa_status='passed'.
+
+        Returns
+        -------
+        List[Dict]
+            Matching runs, oldest first.
+        """
+        self.flush()
+        conditions, args = [], []
+        if status is not None:
+            equals['status'] = status
+        for column, value in equals.items():
+            conditions.append(f"{_quote(column)} = ?")
+            args.append(value)
+        for column, (lo, hi) in (ranges or {}).items():
+            conditions.append(f"{_quote(column)} BETWEEN ? AND ?")
+            args += [lo, hi]
+        unknown = [c for c in list(equals) + list(ranges or {}) if c not in self._columns]
+        if unknown:
+            self.logger.warning(f"Unknown run catalog column(s) {unknown}; no run selected.")
+            return []
+
+        where = f" WHERE {' AND '.join(conditions)}" if conditions else ''
+        table = 'latest_runs' if latest else 'runs'
+        return self.query(f"SELECT * FROM {table}{where} ORDER BY run_id", args)
@@ -0,0 +1,127 @@
+import os
+import json
+import time
+import math
+import logging
+import platform
+
+from contextlib import contextmanager
+from datetime import datetime
+from typing import Dict, Iterator, List
+
+
+MATLAB_METRICS_FILE = 'matlab_metrics.json'
+METRICS_FILE = 'metrics.json'
+
+
+class StageTimer:
+    def __init__(self) -> None:
+        """Wall time [s] of named stages; repeated stages accumulate."""
+        self.stages: Dict[str, float] = {}
+
+    @contextmanager
+    def stage(self, name: str) -> Iterator[None]:
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.stages[name] = self.stages.get(name, 0.0) + time.perf_counter() - start
+
+
+def clear_case_metrics(case_dir: str) -> None:
+    """
+    Remove the MATLAB metrics left in a case directory by a previous run,
+    so a run that dies before writing its own does not report them.
+    """
+    try:
+        os.remove(os.path.join(case_dir, MATLAB_METRICS_FILE))
+    except FileNotFoundError:
+        pass
+
+
+def write_case_metrics(case_dir: str, case_name: str, python_stages: Dict[str, float],
+                       status: str = 'done') -> Dict:
+    """
+    Merge the Python stage timings of a case with the metrics written by
+    `co2lab3DPUMLE.m` (stage timings, solver statistics, peak memory and
+    bytes written) into `metrics.json` in the case directory, with the
+    host and completion time of the run.
+
+    Parameters
+    ----------
+    case_dir : str
+        Case scratch directory (holds `report.txt` and the outputs).
+    case_name : str
+        Name of the case.
+    python_stages : Dict[str, float]
+        Wall time [s] of the Python stages.
+    status : str
+        Completion status of the case.
+
+    Returns
+    -------
+    Dict
+        The merged metrics.
+    """
+    metrics = {'case_name': case_name, 'status': status, 'host': platform.node(),
+               'finished': datetime.now().isoformat(timespec='seconds')}
+    matlab_file = os.path.join(case_dir, MATLAB_METRICS_FILE)
+    if os.path.isfile(matlab_file):
+        try:
+            with open(matlab_file) as f:
+                metrics['matlab'] = json.load(f)
+        except (OSError, json.JSONDecodeError) as e:
+            logging.getLogger("PUMLELogger").warning(f"Unreadable MATLAB metrics '{matlab_file}': {e}")
+    metrics['python'] = {'stages': dict(python_stages)}
+
+    # time spent starting/stopping MATLAB, outside the script itself
+    matlab_total = metrics.get('matlab', {}).get('stages', {}).get('total')
+    if 'matlab_run' in python_stages and isinstance(matlab_total, (int, float)):
+        metrics['python']['stages']['matlab_launch'] = max(0.0, python_stages['matlab_run'] - matlab_total)
+
+    with open(os.path.join(case_dir, METRICS_FILE), 'w') as f:
+        json.dump(metrics, f, indent=2)
+    return metrics
+
+
+def numeric_leaves(d: Dict, prefix: str = '') -> Dict[str, float]:
+    """Numeric entries of nested dicts, keyed by their dotted path (e.g. 'matlab.stages.simulate')."""
+    out = {}
+    for k, v in d.items():
+        key = f"{prefix}{k}"
+        if isinstance(v, dict):
+            out.update(numeric_leaves(v, key + '.'))
+        elif isinstance(v, (int, float)) and not isinstance(v, bool):
+            out[key] = float(v)
+    return out
+
+
+def aggregate_metrics(case_metrics: List[Dict]) -> Dict:
+    """
+    Aggregate the metrics of the cases of a sweep.
+
+    Every numeric entry (e.g. 'matlab.stages.simulate',
+    'matlab.solver.linear_iterations') is summarized by its total, mean,
+    min and max over the cases that report it.
+
+    Returns
+    -------
+    Dict
+        {'cases': n, 'failed': n_failed, 'summary': {entry: stats}}
+    """
+    values: Dict[str, List[float]] = {}
+    for metrics in case_metrics:
+        for key, v in numeric_leaves(metrics).items():
+            values.setdefault(key, []).append(v)
+
+    summary = {}
+    for key, v in sorted(values.items()):
+        v = [x for x in v if math.isfinite(x)]
+        if not v:
+            continue
+        summary[key] = {'total': sum(v), 'mean': sum(v) / len(v),
+                        'min': min(v), 'max': max(v), 'count': len(v)}
+
+    return {'cases': len(case_metrics),
+            'failed': sum(m.get('status') == 'failed' for m in case_metrics),
+            'summary': summary}
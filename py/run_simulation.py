@@ -1,6 +1,10 @@
+import os
+
+from dataset_store import ShardedStore
 from generate_dataset import GenerateDataset
 from read_sim_params import ReadSimulationParams
 from simulation_dataset import SimulationDataset
+from sweep_design import SweepDesign
 
 
 NUM_SIMULATIONS = 1
@@ -12,13 +16,44 @@ if __name__ == "__main__":
     # Generate the dataset
     gen_dataset = GenerateDataset(params)
 
-    # Run multiple simulations
-    gen_dataset.run_multiple_simulations(NUM_SIMULATIONS)
+    # Run the sweep declared in [Sweep], or multiple simulations otherwise
+    # (rerunning resumes the sweep: completed cases are skipped)
+    # With [Active Learning] enabled, the cases are chosen by a surrogate instead
+    if params['Active Learning']['enabled']:
+        statuses = gen_dataset.run_active_learning()
+    elif SweepDesign(params).enabled:
+        statuses = gen_dataset.run_sweep()
+    else:
+        statuses = gen_dataset.run_multiple_simulations(NUM_SIMULATIONS)
+
+    failed = [name for name, status in statuses.items() if status == 'failed']
+    if failed:
+        raise SystemExit(f"{len(failed)} case(s) failed: {', '.join(failed)}. Rerun to resume the sweep.")
+
+    # Well-placement/rate sweep reusing the grid and model in one MATLAB session
+    # from well_placement import placement_scenarios
+    # scenarios = placement_scenarios(params['Wells']['wells_list'], 'NA1A',
+    #                                 positions=[(38, 36), (30, 30), (44, 43)], rates=[1e5, 1.5e5])
+    # gen_dataset.run_well_sweep(scenarios)
+
+    # Add the new cases to the sharded dataset store (one new shard per batch)
+    # store = ShardedStore(os.path.join(params['Paths']['PUMLE_ROOT'], 'dataset', 'store'))
+    # store.ingest(os.path.join(params['Paths']['PUMLE_ROOT'], params['Paths']['PUMLE_RESULTS']))
+
+    # Train on (t, t+1) windows of SG straight from the store shards
+    # from torch_dataset import ShardWindowDataset, make_loader
+    # loader = make_loader(ShardWindowDataset(store, fields=('SG',), shuffle=True), batch_size=8)
+
+    # Or export normalized float16 tensors once and train from them
+    # from tensor_export import TensorExport
+    # from torch_dataset import TensorWindowDataset
+    # TensorExport(store, fields=('P', 'SG'), dtype='float16').export('dataset/tensors', store.select(fidelity='3d'))
+    # loader = make_loader(TensorWindowDataset('dataset/tensors'), batch_size=8, shuffle=True)
 
     # Instance of the simulation dataset
     # sim_data = SimulationDataset(params['Paths']['PUMLE_RESULTS'])
     
-    # Read the simulation data files
+    # Read the simulation data files (P, SW and SG, in parallel)
     # data_numpy = sim_data.read_files()
     
     # Save the simulation data as a numpy file
@@ -0,0 +1,26 @@
+import sys
+import json
+
+from execution_backends import run_remote_case
+
+
+if __name__ == "__main__":
+    # One task of a SLURM job array (see SlurmBackend): runs its contiguous
+    # slice of the case table and writes the status of each of its cases
+    table_file, task, attempt = sys.argv[1], int(sys.argv[2]), int(sys.argv[3])
+    with open(table_file) as f:
+        table = json.load(f)
+
+    cases, n_tasks = table['cases'], table['n_tasks']
+    start, stop = task * len(cases) // n_tasks, (task + 1) * len(cases) // n_tasks
+
+    statuses = {}
+    for case in cases[start:stop]:
+        statuses[case['Pre-Processing']['case_name']] = run_remote_case(case, table['node_scratch'])
+
+    out = table_file.replace('case_table.json', f'status_{attempt}_{task}.json')
+    with open(out, 'w') as f:
+        json.dump(statuses, f, indent=2)
+
+    if 'failed' in statuses.values():
+        raise SystemExit(f"{list(statuses.values()).count('failed')} case(s) failed.")
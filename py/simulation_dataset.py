@@ -2,8 +2,86 @@ import os
 import logging
 import numpy as np
 
+from concurrent.futures import ProcessPoolExecutor
 from scipy.io import loadmat
-from typing import List, Tuple, Dict
+from typing import List, Optional, Sequence, Tuple, Dict, Union
+
+from field_store import FieldStore
+
+
+STATE_FIELDS = ('P', 'SW', 'SG')
+SIMULATION_FILE_TYPES = ('.h5', '.mat')
+
+
+def _ingest_file(task: Tuple) -> Union[None, Dict[str, np.ndarray], Exception]:
+    """
+    Worker of `SimulationDataset.read_files`: decode all fields of one file.
+
+    Writes into the on-disk output arrays when they are given and returns
+    None; otherwise returns the arrays. Errors, including fields whose
+    (timesteps, active cells) shape differs from the probed one, are
+    returned, not raised, so that one bad file does not stop the ingestion.
+    """
+    i, file_path, fields, steps, dtype, shape, out_paths = task
+    try:
+        reader = SimulationDataset._read_store_case if file_path.endswith('.h5') \
+            else SimulationDataset._read_mat_case
+        case = reader(file_path, fields, steps, np.dtype(dtype))
+        for f in fields:
+            if case[f].shape != shape:
+                raise ValueError(f"{f} has shape {case[f].shape}, expected {shape}")
+        if not out_paths:
+            return case.fields
+        for f in fields:
+            out = np.load(out_paths[f], mmap_mode='r+')
+            out[i] = case[f]
+            out.flush()
+        return None
+    except Exception as e:
+        return e
+
+
+class CaseFields:
+    def __init__(self, fields: Dict[str, np.ndarray], index_map: np.ndarray,
+                 cart_dims: Tuple[int, ...], time: np.ndarray) -> None:
+        """Fields of one simulation case in active-cell compact layout.
+
+        Parameters
+        ----------
+        fields : Dict[str, np.ndarray]
+            Arrays of shape (timesteps, active cells), keyed by field name.
+        index_map : np.ndarray
+            Linear Cartesian index (0-based, Fortran order) of each active cell.
+        cart_dims : Tuple[int, ...]
+            Logical grid dimensions, e.g. (I, J, K).
+        time : np.ndarray
+            Time of each stored timestep.
+        """
+        self.fields = fields
+        self.index_map = index_map
+        self.cart_dims = tuple(cart_dims)
+        self.time = time
+
+    def __getitem__(self, field: str) -> np.ndarray:
+        return self.fields[field.upper()]
+
+    @property
+    def nbytes(self) -> int:
+        return sum(v.nbytes for v in self.fields.values())
+
+    def dense(self, field: str, fill: float = 0.0) -> np.ndarray:
+        """
+        Expand a field to the full logical grid.
+
+        Returns
+        -------
+        np.ndarray
+            Array of shape (*cart_dims, timesteps), inactive cells set to `fill`.
+        """
+        values = self[field]
+        out = np.full((values.shape[0], int(np.prod(self.cart_dims))), fill, dtype=values.dtype)
+        out[:, self.index_map] = values
+        return out.reshape((values.shape[0], *self.cart_dims[::-1])).transpose()
 
 
 class SimulationDataset:
@@ -55,110 +133,266 @@ class SimulationDataset:
             self.logger.error(f"Data path is not a directory: {self.data_path}")
             raise NotADirectoryError(f"Data path is not a directory: {self.data_path}")
 
-    def read_file(self, file_name: str) -> np.ndarray:
-        """Read simulation data from a Matlab file.
+    def read_case(self, file_name: str, fields: Optional[Sequence[str]] = None,
+                  steps: Optional[Union[int, slice, Sequence[int]]] = None,
+                  dtype: np.dtype = np.float32) -> "CaseFields":
+        """Read the requested fields and timesteps of one simulation file.
+
+        Values are kept in the active-cell compact layout; use
+        `CaseFields.dense` to expand a field to (I, J, K, t).
 
         Parameters
         ----------
         file_name : str
-            Name of the Matlab file to read.
+            Name of the HDF5 store (.h5) or Matlab (.mat) file to read.
+        fields : Sequence[str], optional
+            Fields among 'P', 'SW', 'SG' (and 'SGMAX' for HDF5 stores);
+            all of them by default.
+        steps : int, slice or sequence of int, optional
+            Timesteps to read (0-based); all of them by default.
+        dtype : np.dtype
+            Output dtype.
 
         Returns
         -------
-        Tuple[np.ndarray, np.ndarray, np.ndarray]
-            Pressure (P), brine saturation (SW), and CO2 saturation (SG) arrays.
+        CaseFields
+            Compact fields with the grid mapping.
         """
         file_path = os.path.join(self.data_path, file_name)
+        fields = [f.upper() for f in (fields or STATE_FIELDS)]
+        if isinstance(steps, (int, np.integer)):
+            steps = [steps]
 
         try:
             self.logger.info(f"Reading file: {file_path}")
-            s = loadmat(file_path)
-
-            # Extract grid dimensions
-            I, J, K = (s['G'][0][0][3][0][0], s['G'][0][0][3][0][1], s['G'][0][0][3][0][2])
-            ncells_total = I * J * K
-
-            # Extract number of timesteps
-            ts = s['states'].shape[0]
-
-            # Extract active cells
-            actnum = s['grdecl'][0][0][3]
-            indices_to_get = np.where(actnum)[0]
-
-            # Initialize arrays
-            P = np.zeros((ncells_total, ts))
-            SW = np.zeros((ncells_total, ts))
-            SG = np.zeros((ncells_total, ts))
-
-            # Populate arrays
-            for ti in range(ts):
-                p = s['states'][ti][0][0][0][0]
-                sw = s['states'][ti][0][0][0][1][:, 0]
-                sg = s['states'][ti][0][0][0][1][:, 1]
-
-                P[indices_to_get, ti] = p.ravel()
-                SW[indices_to_get, ti] = sw.ravel()
-                SG[indices_to_get, ti] = sg.ravel()
-
-            # Reshape arrays
-            states = {
-                "P"  : P.reshape((I, J, K, ts), order='F'),
-                "SW" : SW.reshape((I, J, K, ts), order='F'),
-                "SG" : SG.reshape((I, J, K, ts), order='F')
-            }
+            if file_name.endswith('.h5'):
+                case = self._read_store_case(file_path, fields, steps, dtype)
+            else:
+                case = self._read_mat_case(file_path, fields, steps, dtype)
             self.logger.info(f"Successfully read file: {file_path}")
-            
-            choosen_state = states.get(self.co2_state)
-            if choosen_state is None:
-                raise ValueError(f"Invalid CO2 state: {self.co2_state}")
-            
-            return choosen_state
+            return case
 
         except Exception as e:
             self.logger.error(f"Failed to read file {file_path}: {e}")
             raise
 
-    def read_files(self) -> np.ndarray:
+    @staticmethod
+    def _read_store_case(file_path: str, fields: Sequence[str], steps, dtype: np.dtype) -> "CaseFields":
+        """Read fields from an HDF5 field store (memory-mapped when uncompressed)."""
+        with FieldStore(file_path) as store:
+            available = store.fields
+            for f in fields:
+                if FieldStore.dataset_name(f) not in available:
+                    raise ValueError(f"Invalid CO2 state: {f}")
+            index = np.arange(store.n_steps)[slice(None) if steps is None else steps]
+            return CaseFields({f: store.read(f, steps, dtype) for f in fields},
+                              store.index_map, store.cart_dims, store.time[index])
+
+    @staticmethod
+    def _read_mat_case(file_path: str, fields: Sequence[str], steps, dtype: np.dtype) -> "CaseFields":
+        """Read fields from a legacy Matlab file holding G, grdecl and states."""
+        s = loadmat(file_path)
+
+        # Extract grid dimensions
+        cart_dims = tuple(int(v) for v in s['G'][0][0][3][0][:3])
+
+        # Extract active cells
+        actnum = s['grdecl'][0][0][3]
+        index_map = np.where(actnum)[0]
+
+        # Extract the requested timesteps
+        index = np.atleast_1d(np.arange(s['states'].shape[0])[slice(None) if steps is None else steps])
+
+        getters = {
+            'P':  lambda st: st[0],
+            'SW': lambda st: st[1][:, 0],
+            'SG': lambda st: st[1][:, 1],
+        }
+        out = {}
+        for f in fields:
+            if f not in getters:
+                raise ValueError(f"Invalid CO2 state: {f}")
+            values = np.empty((index.size, index_map.size), dtype=dtype)
+            for i, ti in enumerate(index):
+                values[i] = getters[f](s['states'][ti][0][0][0]).ravel()
+            out[f] = values
+
+        return CaseFields(out, index_map, cart_dims, index.astype(np.float64))
+
+    def read_summaries(self) -> Dict[str, Dict[str, np.ndarray]]:
         """
-        Read all simulation data files in the data path and combine them into a single NumPy array.
+        Read the plume summary series of all HDF5 stores in the data path,
+        without touching their fields.
+
+        Returns
+        -------
+        Dict[str, Dict[str, np.ndarray]]
+            Series of each case (see `FieldStore.summary`), keyed by file
+            path relative to the data path; stores without a summary are left out.
+        """
+        out = {}
+        for name in self.list_files():
+            if not name.endswith('.h5'):
+                continue
+            try:
+                with FieldStore(os.path.join(self.data_path, name)) as store:
+                    summary = store.summary()
+            except Exception as e:
+                self.logger.warning(f"Failed to read the summary of {name}: {e}")
+                continue
+            if summary:
+                out[name] = summary
+        return out
+
+    def read_file(self, file_name: str) -> np.ndarray:
+        """Read simulation data from a Matlab file or HDF5 field store.
+
+        Parameters
+        ----------
+        file_name : str
+            Name of the file to read.
 
         Returns
         -------
         np.ndarray
-            Combined array where the first dimension corresponds to different files.
-            Shape: (num_files, ...) where `...` is the shape of the data from each file.
+            Dense (I, J, K, t) array of the chosen CO2 state (P, SW or SG).
         """
-        self.logger.info(f"Reading all files in directory: {self.data_path}")
+        return self.read_case(file_name, fields=[self.co2_state], dtype=np.float64).dense(self.co2_state)
 
-        data = []
-        for file_name in os.listdir(self.data_path):
-            if file_name.endswith('.mat'):
-                try:
-                    data.append(self.read_file(file_name))
-                except Exception as e:
-                    self.logger.warning(f"Skipping file {file_name} due to error: {e}")
+    def list_files(self) -> List[str]:
+        """
+        List the simulation files (`states_<case>.h5/.mat`) under the data
+        path, including the per-case scratch directories, in a deterministic
+        (sorted) order. Parameter and batch `.mat` files are left out.
+
+        Returns
+        -------
+        List[str]
+            File paths relative to the data path.
+        """
+        files = []
+        for root, _, names in os.walk(self.data_path):
+            for name in names:
+                if name.startswith('states_') and name.endswith(SIMULATION_FILE_TYPES):
+                    files.append(os.path.relpath(os.path.join(root, name), self.data_path))
+        return sorted(files)
+
+    def read_files(self, fields: Optional[Sequence[str]] = None,
+                   steps: Optional[Union[slice, Sequence[int]]] = None,
+                   dtype: np.dtype = np.float32, workers: Optional[int] = None,
+                   out_dir: Optional[str] = None, files: Optional[Sequence[str]] = None) -> Dict[str, np.ndarray]:
+        """
+        Read all simulation data files in the data path in parallel.
+
+        Each file is decoded once for all requested fields by a pool of
+        worker processes. Results are written directly into preallocated
+        arrays, in the order of `list_files`, either in memory or, with
+        `out_dir`, into `<field>.npy` files opened as memory maps.
+        Files that cannot be read, or whose shape differs from the first
+        readable one (e.g. another number of timesteps), are marked invalid
+        and NaN-filled: flagged in `valid.npy` with `out_dir`, dropped from
+        the in-memory arrays otherwise.
+
+        Parameters
+        ----------
+        fields : Sequence[str], optional
+            Fields among 'P', 'SW', 'SG'; all of them by default.
+        steps : slice or sequence of int, optional
+            Timesteps to read (0-based); all of them by default.
+        dtype : np.dtype
+            Output dtype.
+        workers : int, optional
+            Number of worker processes (defaults to the number of cores).
+        out_dir : str, optional
+            Folder of the on-disk output arrays.
+        files : Sequence[str], optional
+            Files to read, relative to the data path (defaults to `list_files`).
+
+        Returns
+        -------
+        Dict[str, np.ndarray]
+            Arrays of shape (num_files, timesteps, active cells), keyed by
+            field. `self.files`, `self.index_map` and `self.cart_dims` 
+            describe the rows and the cell layout.
+        """
+        self.logger.info(f"Reading all files in directory: {self.data_path}")
 
-        if not data:
+        files = list(files) if files is not None else self.list_files()
+        if not files:
             self.logger.error("No valid files found in the directory.")
             raise ValueError("No valid simulation data files to read.")
 
-        # Combine data into a single NumPy array
-        combined_data = np.stack(data)
-        self.logger.info(f"Finished reading files. Combined data shape: {combined_data.shape}")
-        return combined_data
+        fields = [f.upper() for f in (fields or STATE_FIELDS)]
+
+        # The first readable file sets the layout shared by all cases
+        probe = None
+        for name in files:
+            try:
+                probe = self.read_case(name, fields=fields[:1], steps=steps, dtype=dtype)
+                break
+            except Exception as e:
+                self.logger.warning(f"Cannot probe file {name}: {e}")
+        if probe is None:
+            self.logger.error("None of the simulation data files is readable.")
+            raise ValueError("No readable simulation data files.")
+        case_shape = probe[fields[0]].shape
+        shape = (len(files), *case_shape)
+
+        out_paths = {}
+        if out_dir:
+            os.makedirs(out_dir, exist_ok=True)
+            out = {}
+            for f in fields:
+                out_paths[f] = os.path.join(out_dir, f"{f}.npy")
+                out[f] = np.lib.format.open_memmap(out_paths[f], mode='w+', dtype=dtype, shape=shape)
+        else:
+            out = {f: np.empty(shape, dtype=dtype) for f in fields}
+
+        tasks = [(i, os.path.join(self.data_path, name), fields, steps, np.dtype(dtype).str, case_shape, out_paths)
+                 for i, name in enumerate(files)]
+        valid = np.ones(len(files), dtype=bool)
+
+        workers = min(workers or os.cpu_count() or 1, len(files))
+        with ProcessPoolExecutor(max_workers=workers) as executor:
+            for i, result in zip(range(len(files)), executor.map(_ingest_file, tasks)):
+                if isinstance(result, Exception):
+                    self.logger.warning(f"Skipping file {files[i]} due to error: {result}")
+                    valid[i] = False
+                    for f in fields:
+                        out[f][i] = np.nan
+                elif result is not None:
+                    for f in fields:
+                        out[f][i] = result[f]
+
+        if out_dir:
+            for f in fields:
+                out[f].flush()
+            np.save(os.path.join(out_dir, 'valid.npy'), valid)
+        elif not valid.all():
+            out = {f: v[valid] for f, v in out.items()}
+
+        self.files = [name for name, ok in zip(files, valid) if ok or out_dir]
+        self.index_map = probe.index_map
+        self.cart_dims = probe.cart_dims
+
+        self.logger.info(f"Finished reading {int(valid.sum())}/{len(files)} files. "
+                         f"Combined data shape: {out[fields[0]].shape}")
+        return out
     
-    def save_as_numpy(self, data: np.ndarray, save_file_name: str) -> None:
+    def save_as_numpy(self, data: Union[np.ndarray, Dict[str, np.ndarray]], save_file_name: str) -> None:
         """Save simulation data as numpy arrays.
 
         Parameters
         ----------
-        data : List[Tuple[np.ndarray, np.ndarray, np.ndarray]]
-            List of tuples containing Pressure (P), brine saturation (SW), and CO2 saturation (SG) arrays.
+        data : np.ndarray or Dict[str, np.ndarray]
+            Array of the chosen CO2 state, or arrays keyed by field as
+            returned by `read_files`.
         """
         self.logger.info(f"Saving simulation data as numpy arrays.")
 
+        arrays = data if isinstance(data, dict) else {self.co2_state: data}
         try:
-            np.savez_compressed(os.path.join(self.data_path, f"{save_file_name}.npz"), {self.co2_state:data})
+            np.savez_compressed(os.path.join(self.data_path, f"{save_file_name}.npz"), **arrays)
         except Exception as e:
             self.logger.error(f"Failed to save simulation data as numpy array: {e}")
 
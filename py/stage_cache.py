@@ -0,0 +1,142 @@
+import os
+import glob
+import json
+import shutil
+import hashlib
+import logging
+
+from datetime import datetime
+from functools import lru_cache
+from typing import Dict, Optional, Sequence
+
+
+PUMLE_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Scripts whose contents make up the version of each stage, relative to the
+# repository root
+STAGE_SCRIPTS = {
+    'grid': ('m/loadGridPUMLE.m', 'm/readGRDECLSidecarPUMLE.m', 'py/grdecl_parser.py'),
+    'simulate': ('m/*.m',),
+    'export': ('py/tensor_export.py',),
+}
+
+
+def files_digest(paths: Sequence[str]) -> str:
+    """SHA-256 of the contents of files, in the given order (truncated to 32 characters)."""
+    h = hashlib.sha256()
+    for path in paths:
+        h.update(os.path.basename(path).encode())
+        with open(path, 'rb') as f:
+            for block in iter(lambda: f.read(1 << 20), b''):
+                h.update(block)
+    return h.hexdigest()[:32]
+
+
+@lru_cache(maxsize=None)
+def code_version(stage: str) -> str:
+    """Digest of the scripts a stage runs (see `STAGE_SCRIPTS`), computed once per process."""
+    paths = sorted({p for pattern in STAGE_SCRIPTS[stage] for p in glob.glob(os.path.join(PUMLE_ROOT, pattern))})
+    return files_digest(paths)
+
+
+def stage_key(stage: str, inputs: Dict) -> str:
+    """
+    Content key of one run of a stage: hash of its inputs (JSON
+    serializable, e.g. setup sections and content digests) and of the
+    version of its scripts.
+    """
+    text = json.dumps({'stage': stage, 'inputs': inputs, 'code': code_version(stage)}, sort_keys=True, default=str)
+    return hashlib.sha256(text.encode()).hexdigest()[:32]
+
+
+def link_tree(src: str, dst: str, link_suffixes: Sequence[str] = ('.h5',)) -> None:
+    """
+    Copy a folder, hard-linking the files with the given suffixes where the
+    file system allows it. Only files that are replaced rather than
+    rewritten in place should be linked (MATLAB deletes an HDF5 store
+    before creating it again), or writing one copy would change the other.
+    """
+    def copy(s, d):
+        if s.endswith(tuple(link_suffixes)):
+            try:
+                if os.path.exists(d):
+                    os.remove(d)
+                os.link(s, d)
+                return
+            except OSError:
+                pass
+        shutil.copy2(s, d)
+    shutil.copytree(src, dst, copy_function=copy, dirs_exist_ok=True)
+
+
+class StageCache:
+    def __init__(self, root: str) -> None:
+        """Content-addressed index of the outputs of pipeline stages.
+
+        Layout::
+
+            root/<stage>/<key>.json     outputs of the run of a stage with that key
+
+        A stage looks up the key of its inputs (`stage_key`) before running
+        and records its outputs once done; a hit whose outputs are still on
+        disk is reused instead of running the stage again, like a build
+        system skips up-to-date targets. Entries only point to the outputs,
+        which stay where the stage wrote them.
+
+        Parameters
+        ----------
+        root : str
+            Cache folder (created if needed).
+        """
+        self.root = root
+        self.logger = logging.getLogger("PUMLELogger")
+        os.makedirs(root, exist_ok=True)
+
+    def _entry(self, stage: str, key: str) -> str:
+        return os.path.join(self.root, stage, f"{key}.json")
+
+    def lookup(self, stage: str, key: str) -> Optional[Dict]:
+        """Entry of a stage key, or None if missing or if any of its outputs is gone."""
+        try:
+            with open(self._entry(stage, key)) as f:
+                entry = json.load(f)
+        except (OSError, json.JSONDecodeError):
+            return None
+        if not all(os.path.exists(p) for p in entry.get('outputs', {}).values()):
+            return None
+        return entry
+
+    def discard(self, stage: str, key: Optional[str] = None, case_name: Optional[str] = None) -> int:
+        """
+        Drop the entry of a stage key, or all the entries recorded for a
+        case (e.g. after its outputs failed the data-quality checks), so
+        they are not reused. Returns the number of entries dropped.
+        """
+        if key is not None:
+            paths = [self._entry(stage, key)]
+        else:
+            paths = glob.glob(os.path.join(self.root, stage, '*.json'))
+        n = 0
+        for path in paths:
+            try:
+                if case_name is not None:
+                    with open(path) as f:
+                        if json.load(f).get('case_name') != case_name:
+                            continue
+                os.remove(path)
+                n += 1
+            except (OSError, json.JSONDecodeError):
+                continue
+        return n
+
+    def commit(self, stage: str, key: str, outputs: Dict[str, str], **meta) -> None:
+        """Record the outputs (name -> path) of a stage run under its key."""
+        path = self._entry(stage, key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        entry = {'stage': stage, 'key': key, 'outputs': {k: os.path.abspath(v) for k, v in outputs.items()},
+                 'created': datetime.now().isoformat(timespec='seconds'), **meta}
+        # write-then-rename, so readers never see a partial entry
+        tmp = f"{path}.{os.getpid()}.tmp"
+        with open(tmp, 'w') as f:
+            json.dump(entry, f, indent=2)
+        os.replace(tmp, path)
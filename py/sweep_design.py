@@ -0,0 +1,168 @@
+import csv
+import logging
+import itertools
+import numpy as np
+
+from copy import deepcopy
+from scipy.stats import qmc
+from typing import Dict, List, Optional, Tuple
+
+
+SAMPLERS = ('none', 'lhs', 'sobol', 'factorial')
+
+# Options of [Sweep] that are not parameter ranges
+SWEEP_OPTIONS = ('sampler', 'samples', 'levels', 'seed')
+
+# Sections whose parameters can be swept
+SWEPT_SECTIONS = ('Fluid', 'Initial Conditions', 'Wells', 'Schedule')
+
+# Swept parameters that take integer values (step counts); setup.ini reads
+# some of them as floats
+INTEGER_PARAMS = {('Schedule', 'injection_timesteps'), ('Schedule', 'migration_timesteps'),
+                  ('Schedule', 'rampup_steps'), ('Schedule', 'target_iterations'),
+                  ('Schedule', 'max_timestep_cuts')}
+
+
+class SweepDesign:
+    def __init__(self, params: Dict) -> None:
+        """Space-filling design of a parameter sweep declared in `[Sweep]`.
+
+        Each option of `[Sweep]` other than `sampler`, `samples`, `levels`
+        and `seed` is a range `min, max` of the parameter with the same name
+        in one of the Fluid, Initial Conditions, Wells or Schedule sections.
+
+        Parameters
+        ----------
+        params : Dict
+            Simulation parameters, including the 'Sweep' section.
+        """
+        self.params = params
+        self.logger = logging.getLogger("PUMLELogger")
+
+        sweep = params.get('Sweep', {})
+        self.sampler = sweep.get('sampler', 'none').strip().lower()
+        if self.sampler not in SAMPLERS:
+            self.logger.error(f"Unknown sweep sampler '{self.sampler}'. Valid samplers: {SAMPLERS}.")
+            raise ValueError(f"Unknown sweep sampler '{self.sampler}'.")
+
+        self.samples = int(sweep.get('samples', 16))
+        self.levels = int(sweep.get('levels', 3))
+        self.seed = int(sweep['seed']) if str(sweep.get('seed', '')).strip() else None
+        self.ranges = self._parse_ranges(sweep)
+
+    @property
+    def enabled(self) -> bool:
+        return self.sampler != 'none' and bool(self.ranges)
+
+    def _parse_ranges(self, sweep: Dict) -> List[Tuple[str, str, float, float]]:
+        """Map each range option to its (section, parameter) in the setup."""
+        ranges = []
+        for option, value in sweep.items():
+            if option.lower() in SWEEP_OPTIONS:
+                continue
+
+            # configparser lowercases option names; recover the original key
+            matches = [(section, key) for section in SWEPT_SECTIONS
+                       for key in self.params.get(section, {}) if key.lower() == option.lower()]
+            if not matches:
+                self.logger.error(f"Swept parameter '{option}' not found in sections {SWEPT_SECTIONS}.")
+                raise ValueError(f"Swept parameter '{option}' not found.")
+
+            try:
+                lo, hi = (float(v) for v in str(value).split(','))
+            except ValueError:
+                self.logger.error(f"Invalid range for swept parameter '{option}': '{value}'. Use 'min, max'.")
+                raise
+            ranges.append((*matches[0], lo, hi))
+        return ranges
+
+    def sample(self) -> np.ndarray:
+        """
+        Generate the design points.
+
+        Returns
+        -------
+        np.ndarray
+            Array of shape (n_cases, n_parameters) with the parameter values.
+        """
+        d = len(self.ranges)
+        lo, hi = self.bounds
+
+        if self.sampler == 'lhs':
+            unit = qmc.LatinHypercube(d=d, seed=self.seed).random(self.samples)
+        elif self.sampler == 'sobol':
+            sobol = qmc.Sobol(d=d, scramble=True, seed=self.seed)
+            m = int(np.log2(self.samples))
+            if 2**m == self.samples:
+                unit = sobol.random_base2(m)
+            else:
+                self.logger.warning(f"Sobol samples should be a power of 2 (got {self.samples}); balance is lost.")
+                unit = sobol.random(self.samples)
+        else:
+            axis = np.linspace(0, 1, self.levels)
+            unit = np.array(list(itertools.product(axis, repeat=d)))
+
+        return lo + unit * (hi - lo)
+
+    @property
+    def bounds(self) -> Tuple[np.ndarray, np.ndarray]:
+        """Lower and upper bounds of the swept parameters."""
+        return np.array([r[2] for r in self.ranges]), np.array([r[3] for r in self.ranges])
+
+    def cases(self, points: Optional[np.ndarray] = None, tag: str = '') -> List[Dict]:
+        """
+        Build the case table: one full copy of the parameters per design point.
+
+        Parameters
+        ----------
+        points : np.ndarray, optional
+            Design points of shape (n_cases, n_parameters); sampled by
+            `sample` by default.
+        tag : str
+            Inserted in the case names before the case number, e.g. 'r01_'.
+
+        Returns
+        -------
+        List[Dict]
+            Parameters of each case, with unique case names. Integer
+            parameters (`INTEGER_PARAMS`, or an integer setup value) get the
+            nearest integer.
+        """
+        points = self.sample() if points is None else np.atleast_2d(points)
+        base_name = self.params['Pre-Processing']['case_name']
+        width = max(4, len(str(len(points))))
+
+        cases = []
+        for i, point in enumerate(points):
+            case = deepcopy(self.params)
+            case.pop('Sweep', None)
+            for (section, key, _, _), value in zip(self.ranges, point):
+                base = self.params[section].get(key)
+                integer = (section, key) in INTEGER_PARAMS or (isinstance(base, int) and not isinstance(base, bool))
+                case[section][key] = int(round(value)) if integer else float(value)
+            case['Pre-Processing']['case_name'] = f"{base_name}_{tag}{i:0{width}d}"
+            cases.append(case)
+
+        self.logger.info(f"Sweep design '{self.sampler}' generated {len(cases)} cases over "
+                         f"{[key for _, key, _, _ in self.ranges]}.")
+        return cases
+
+    def write_case_table(self, cases: List[Dict], file_path: str) -> None:
+        """
+        Save the case table as CSV (one row per case, one column per swept parameter).
+
+        Parameters
+        ----------
+        cases : List[Dict]
+            Cases returned by `cases`.
+        file_path : str
+            Output CSV file.
+        """
+        columns = [f"{section}.{key}" for section, key, _, _ in self.ranges]
+        with open(file_path, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['case_name'] + columns)
+            for case in cases:
+                writer.writerow([case['Pre-Processing']['case_name']] +
+                                [case[section][key] for section, key, _, _ in self.ranges])
+        self.logger.info(f"Case table saved to '{file_path}'.")
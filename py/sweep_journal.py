@@ -0,0 +1,120 @@
+import os
+import json
+import hashlib
+import logging
+import threading
+
+from datetime import datetime
+from typing import Dict, Optional, Tuple
+
+
+# Sections that do not change the results of a case
+UNHASHED_SECTIONS = ('Paths', 'MATLAB', 'Execution', 'Active Learning')
+UNHASHED_KEYS = {'Grid': ('cache', 'cache_dir', 'sidecar', 'sidecar_path'), 'Output': ('restart',),
+                 'Solver': ('warm_start_files', 'warm_start_weights')}
+
+
+class SweepJournal:
+    def __init__(self, path: str) -> None:
+        """Append-only journal of the status of each case of a sweep.
+
+        Each line is a JSON record with the case name, the hash of its
+        parameters, its status ('pending', 'running', 'done', 'failed' or
+        'requeued') and a timestamp. The last record of a case is its
+        current state, so a restarted sweep can skip the cases already done
+        with the same parameters, resume the ones that were interrupted and
+        rerun the requeued ones from scratch.
+
+        Parameters
+        ----------
+        path : str
+            Journal file (JSON lines), created if needed.
+        """
+        self.path = path
+        self.logger = logging.getLogger("PUMLELogger")
+        self._lock = threading.Lock()
+        self._last: Dict[str, Dict] = {}
+        self._requeues: Dict[Tuple[str, Optional[str]], int] = {}
+
+        if os.path.isfile(path):
+            with open(path) as f:
+                for line in f:
+                    try:
+                        record = json.loads(line)
+                    except json.JSONDecodeError:
+                        # a line cut short by the interruption
+                        continue
+                    self._count(record)
+
+    @staticmethod
+    def case_hash(case: Dict) -> str:
+        """
+        Hash of the parameters of a case that determine its results.
+
+        Paths, MATLAB, execution and active-learning settings are left out,
+        as are the grid cache settings (the deck enters through its
+        `cache_key`), the per-case `[Output] restart` flag and the donors
+        of the warm start, which depend on the catalog at launch time; the
+        warm start options themselves are hashed.
+        """
+        content = {s: v for s, v in case.items() if s not in UNHASHED_SECTIONS}
+        for section, keys in UNHASHED_KEYS.items():
+            if isinstance(content.get(section), dict):
+                content[section] = {k: v for k, v in content[section].items() if k not in keys}
+        text = json.dumps(content, sort_keys=True, default=str)
+        return hashlib.sha256(text.encode()).hexdigest()[:32]
+
+    def last(self, case_name: str) -> Optional[Dict]:
+        """Latest record of a case, if any."""
+        with self._lock:
+            return self._last.get(case_name)
+
+    def record(self, case: Dict, status: str, **extra) -> None:
+        """Append the status of a case to the journal."""
+        self._append({'case_name': case['Pre-Processing']['case_name'], 'hash': self.case_hash(case),
+                      'status': status, 'time': datetime.now().isoformat(timespec='seconds'), **extra})
+
+    def requeue(self, case_name: str, **extra) -> bool:
+        """
+        Mark a completed case to be run again from scratch, e.g. after it
+        failed the data-quality checks; its parameters hash is kept.
+        Returns False if the case is not in the journal.
+        """
+        last = self.last(case_name)
+        if not last:
+            return False
+        self._append({'case_name': case_name, 'hash': last['hash'], 'status': 'requeued',
+                      'time': datetime.now().isoformat(timespec='seconds'), **extra})
+        return True
+
+    def requeues(self, case_name: str, reason: Optional[str] = None) -> int:
+        """Number of times a case was requeued (for the given reason, e.g. 'qa')."""
+        with self._lock:
+            return self._requeues.get((case_name, reason), 0)
+
+    def _count(self, record: Dict) -> None:
+        self._last[record['case_name']] = record
+        if record['status'] == 'requeued':
+            for key in ((record['case_name'], None), (record['case_name'], record.get('reason'))):
+                self._requeues[key] = self._requeues.get(key, 0) + 1
+
+    def _append(self, record: Dict) -> None:
+        with self._lock:
+            self._count(record)
+            try:
+                with open(self.path, 'a') as f:
+                    f.write(json.dumps(record) + '\n')
+                    f.flush()
+                    os.fsync(f.fileno())
+            except Exception as e:
+                self.logger.error(f"Failed to write sweep journal '{self.path}': {e}")
+
+    def is_done(self, case: Dict) -> bool:
+        """Whether the case was completed with the same parameters."""
+        last = self.last(case['Pre-Processing']['case_name'])
+        return bool(last) and last['status'] == 'done' and last['hash'] == self.case_hash(case)
+
+    def was_interrupted(self, case: Dict) -> bool:
+        """Whether the case was started with the same parameters but not completed."""
+        last = self.last(case['Pre-Processing']['case_name'])
+        return bool(last) and last['status'] in ('running', 'failed') and last['hash'] == self.case_hash(case)
@@ -0,0 +1,115 @@
+import os
+import json
+import logging
+import threading
+
+from concurrent.futures import ThreadPoolExecutor
+from typing import Callable, Dict, List, Optional
+
+from sweep_journal import SweepJournal
+
+
+class SweepScheduler:
+    def __init__(self, runner: Callable[[Dict], Optional[str]], workers: int = 0,
+                 memory_per_case: float = 4.0, journal: Optional[SweepJournal] = None) -> None:
+        """Run the cases of a sweep concurrently on the local node.
+
+        Parameters
+        ----------
+        runner : Callable[[Dict], Optional[str]]
+            Runs one case given its parameters. A case fails when the runner
+            raises or returns 'failed'.
+        workers : int
+            Number of cases run at once. Use 0 to size it from the available
+            cores and memory.
+        memory_per_case : float
+            Expected peak memory of one case [GB], used when `workers` is 0.
+        journal : SweepJournal, optional
+            Journal where every status change of a case is recorded.
+        """
+        self.runner = runner
+        self.workers = workers if workers > 0 else self.default_workers(memory_per_case)
+        self.logger = logging.getLogger("PUMLELogger")
+        self.journal = journal
+        self.status: Dict[str, str] = {}
+        self._lock = threading.Lock()
+
+    @staticmethod
+    def default_workers(memory_per_case: float) -> int:
+        """Number of concurrent cases that fit in the cores and memory of the node."""
+        if hasattr(os, 'sched_getaffinity'):
+            cores = len(os.sched_getaffinity(0))
+        else:
+            cores = os.cpu_count() or 1
+        try:
+            mem_gb = os.sysconf('SC_PAGE_SIZE') * os.sysconf('SC_PHYS_PAGES') / 1024**3
+        except (AttributeError, ValueError, OSError):
+            return cores
+        return max(1, min(cores, int(mem_gb // max(memory_per_case, 1e-3))))
+
+    def _set_status(self, case: Dict, status: str, **extra) -> None:
+        with self._lock:
+            self.status[case['Pre-Processing']['case_name']] = status
+        if self.journal is not None:
+            self.journal.record(case, status, **extra)
+
+    def _run_one(self, case: Dict) -> str:
+        """Run a single case, isolating its failure from the other cases."""
+        case_name = case['Pre-Processing']['case_name']
+        self._set_status(case, 'running')
+        error = {}
+        try:
+            status = 'failed' if self.runner(case) == 'failed' else 'done'
+        except Exception as e:
+            self.logger.error(f"Case '{case_name}' failed: {e}")
+            status, error = 'failed', {'error': str(e)}
+        self._set_status(case, status, **error)
+        self.logger.info(f"Case '{case_name}' finished with status '{status}'.")
+        return status
+
+    def run(self, cases: List[Dict], status_file: Optional[str] = None,
+            skip: Optional[Callable[[Dict], bool]] = None) -> Dict[str, str]:
+        """
+        Run all cases, K at a time.
+
+        Parameters
+        ----------
+        cases : List[Dict]
+            Parameters of each case; case names must be unique.
+        status_file : str, optional
+            JSON file where the final status of each case is written.
+        skip : Callable[[Dict], bool], optional
+            Tells the cases already completed; they are reported as 'done'
+            without being run.
+
+        Returns
+        -------
+        Dict[str, str]
+            Status of each case ('done' or 'failed'), in submission order.
+        """
+        todo = []
+        for case in cases:
+            if skip is not None and skip(case):
+                with self._lock:
+                    self.status[case['Pre-Processing']['case_name']] = 'done'
+            else:
+                self._set_status(case, 'pending')
+                todo.append(case)
+        if len(todo) < len(cases):
+            self.logger.info(f"Skipping {len(cases) - len(todo)} case(s) already completed.")
+
+        self.logger.info(f"Running {len(todo)} case(s) with {self.workers} concurrent worker(s).")
+        with ThreadPoolExecutor(max_workers=self.workers) as executor:
+            list(executor.map(self._run_one, todo))
+
+        result = {c['Pre-Processing']['case_name']: self.status[c['Pre-Processing']['case_name']] for c in cases}
+        n_failed = sum(s == 'failed' for s in result.values())
+        self.logger.info(f"Sweep finished: {len(cases) - n_failed} done, {n_failed} failed.")
+
+        if status_file:
+            try:
+                with open(status_file, 'w') as f:
+                    json.dump(result, f, indent=2)
+            except Exception as e:
+                self.logger.error(f"Failed to write sweep status file '{status_file}': {e}")
+        return result
@@ -0,0 +1,251 @@
+import os
+import json
+import logging
+import numpy as np
+
+from datetime import datetime
+from typing import Dict, Iterator, Optional, Sequence, Tuple
+
+from dataset_store import ShardedStore
+from stage_cache import stage_key
+
+
+TENSOR_MANIFEST = 'tensors.json'
+TENSOR_DTYPES = ('float16', 'bfloat16')
+NORMALIZATIONS = ('standard', 'minmax')
+
+
+def to_bfloat16(values: np.ndarray) -> np.ndarray:
+    """
+    Round float32 values to bfloat16, returned as their uint16 bit patterns
+    (NumPy has no bfloat16; `torch.from_numpy(a.view(np.int16)).view(torch.bfloat16)`
+    reinterprets them). Rounds to nearest, ties to even.
+    """
+    bits = np.ascontiguousarray(values, dtype=np.float32).view(np.uint32)
+    rounded = (bits + np.uint32(0x7FFF) + ((bits >> np.uint32(16)) & np.uint32(1))) >> np.uint32(16)
+    # NaN must stay NaN after rounding: keep the high bits and force a mantissa bit
+    nan = np.isnan(values)
+    if nan.any():
+        rounded[nan] = (bits[nan] >> np.uint32(16)) | np.uint32(0x40)
+    return rounded.astype(np.uint16)
+
+
+def from_bfloat16(bits: np.ndarray) -> np.ndarray:
+    """float32 values of bfloat16 bit patterns written by `to_bfloat16`."""
+    return (np.asarray(bits, dtype=np.uint16).astype(np.uint32) << np.uint32(16)).view(np.float32)
+
+
+class TensorExport:
+    def __init__(self, store: ShardedStore, fields: Sequence[str] = ('P', 'SG'),
+                 dtype: str = 'float16', normalization: str = 'standard', block: int = 16) -> None:
+        """Export of the cases of a `ShardedStore` as normalized half-precision training tensors.
+
+        Layout::
+
+            out_dir/tensors.json     manifest: shape, layout, dtype, fields, cases,
+                                     normalization constants and grid
+            out_dir/tensors.npy      (cases, timesteps, C, D, H, W) in C order
+            out_dir/mask.npy         (D, H, W) active cells (uint8)
+
+        The tensor is in the layout batches of `ShardWindowDataset` have,
+        one channel per field and (D, H, W) = (K, J, I) (D = 1 for VE
+        cases), so windows are contiguous slices of the memory map and reach
+        the model without a permute. Fields are normalized with statistics
+        over the active cells of all exported cases, computed in one
+        streaming pass over the shards; inactive cells are 0 after
+        normalization. bfloat16 tensors are stored as uint16 bit patterns
+        (see `to_bfloat16`).
+
+        Parameters
+        ----------
+        store : ShardedStore
+            Store to export.
+        fields : Sequence[str]
+            Fields exported as channels.
+        dtype : str
+            'float16' or 'bfloat16'. Use 'bfloat16' for fields whose
+            normalized values may exceed the float16 range (|x| > 65504).
+        normalization : str
+            'standard' ((x - mean) / std) or 'minmax' ((x - min) / (max - min)).
+        block : int
+            Timesteps read at a time from the shards.
+        """
+        self.store = store
+        self.fields = [f.upper() for f in fields]
+        self.dtype = dtype.lower()
+        self.normalization = normalization.lower()
+        self.block = block
+        self.logger = logging.getLogger("SimulationDatasetLogger")
+
+        if self.dtype not in TENSOR_DTYPES:
+            self.logger.error(f"Unknown tensor dtype '{dtype}'. Valid dtypes: {TENSOR_DTYPES}.")
+            raise ValueError(f"Unknown tensor dtype '{dtype}'.")
+        if self.normalization not in NORMALIZATIONS:
+            self.logger.error(f"Unknown normalization '{normalization}'. Valid options: {NORMALIZATIONS}.")
+            raise ValueError(f"Unknown normalization '{normalization}'.")
+
+    def _blocks(self, record: Dict, field: str, maps: Dict) -> Iterator[Tuple[int, np.ndarray]]:
+        """(first timestep, float64 block of (timesteps, active cells)) of one case field."""
+        key = (record['shard'], field)
+        if key not in maps:
+            maps[key] = self.store.open_field(record['shard'], field)
+        rows = maps[key][record['offset']]
+        for start in range(0, record['n_steps'], self.block):
+            yield start, np.asarray(rows[start:start + self.block], dtype=np.float64)
+
+    def statistics(self, records: Sequence[Dict]) -> Dict[str, Dict[str, float]]:
+        """
+        Mean, standard deviation, minimum and maximum of each field over the
+        active cells of the given cases, in one streaming pass (block sums
+        combined with Chan's parallel update, so large fields do not lose
+        precision).
+        """
+        acc = {f: [0, 0.0, 0.0, np.inf, -np.inf] for f in self.fields}
+        maps = {}
+        for record in records:
+            for field in self.fields:
+                for _, values in self._blocks(record, field, maps):
+                    values = values[np.isfinite(values)]
+                    if not values.size:
+                        continue
+                    n, mean, m2, lo, hi = acc[field]
+                    nb, mb = values.size, float(values.mean())
+                    delta = mb - mean
+                    total = n + nb
+                    acc[field] = [total, mean + delta * nb / total,
+                                  m2 + float(((values - mb) ** 2).sum()) + delta ** 2 * n * nb / total,
+                                  min(lo, float(values.min())), max(hi, float(values.max()))]
+
+        stats = {}
+        for field, (n, mean, m2, lo, hi) in acc.items():
+            stats[field] = {'mean': mean, 'std': float(np.sqrt(m2 / n)) if n else 0.0,
+                            'min': lo if n else 0.0, 'max': hi if n else 0.0, 'count': n}
+        return stats
+
+    def _scale(self, stats: Dict[str, float]) -> Tuple[float, float]:
+        """(offset, scale) of a field: normalized = (x - offset) / scale."""
+        if self.normalization == 'standard':
+            offset, scale = stats['mean'], stats['std']
+        else:
+            offset, scale = stats['min'], stats['max'] - stats['min']
+        return offset, scale if scale > 0 else 1.0
+
+    def export(self, out_dir: str, records: Optional[Sequence[Dict]] = None) -> Dict:
+        """
+        Write the normalized tensors of the given cases. The export is
+        skipped if `out_dir` already holds the tensors of the same cases,
+        settings and `tensor_export.py` (manifest 'key').
+
+        Parameters
+        ----------
+        out_dir : str
+            Output folder (created if needed).
+        records : Sequence[Dict], optional
+            Case records of one fidelity and number of timesteps, e.g. from
+            `store.select(fidelity='3d')`; all cases by default.
+
+        Returns
+        -------
+        Dict
+            The manifest, also saved as `tensors.json`.
+        """
+        records = list(records) if records is not None else list(self.store.manifest().values())
+        if not records:
+            self.logger.error("No cases to export.")
+            raise ValueError("No cases to export.")
+        for attr in ('fidelity', 'n_steps'):
+            values = sorted({str(r.get(attr, '3d')) for r in records})
+            if len(values) > 1:
+                self.logger.error(f"Cases with different {attr} {values} cannot be exported into one tensor.")
+                raise ValueError(f"Cases with different {attr} {values} cannot be exported into one tensor.")
+        for record in records:
+            missing = [f for f in self.fields if f not in record.get('fields', [])]
+            if missing:
+                self.logger.error(f"Case '{record['case_name']}' has no field(s) {missing}.")
+                raise ValueError(f"Case '{record['case_name']}' has no field(s) {missing}.")
+
+        # the export is skipped when its inputs and script did not change
+        key = stage_key('export', {'fields': self.fields, 'dtype': self.dtype, 'normalization': self.normalization,
+                                   'cases': [(r['case_name'], r['shard'], r['offset'], r.get('source_mtime'))
+                                             for r in records]})
+        try:
+            manifest = read_tensor_manifest(out_dir)
+            if manifest.get('key') == key and os.path.isfile(os.path.join(out_dir, manifest['file'])):
+                self.logger.info(f"Tensors in '{out_dir}' are up to date; export skipped.")
+                return manifest
+        except (OSError, json.JSONDecodeError):
+            pass
+
+        fidelity = records[0].get('fidelity', '3d')
+        n_steps = int(records[0]['n_steps'])
+        index_map, cart_dims = self.store.grid(fidelity)
+        index_map = index_map.astype(np.int64)
+        cart_dims = tuple(cart_dims) + (1,) * (3 - len(cart_dims))
+        # Fortran-order (I, J, K) linear indices are C-order (K, J, I) ones
+        volume_shape = tuple(reversed(cart_dims))
+        n_dense = int(np.prod(cart_dims))
+
+        os.makedirs(out_dir, exist_ok=True)
+        mask = np.zeros(n_dense, dtype=np.uint8)
+        mask[index_map] = 1
+        np.save(os.path.join(out_dir, 'mask.npy'), mask.reshape(volume_shape))
+
+        stats = self.statistics(records)
+        self.logger.info(f"Normalization statistics of {self.fields} computed over {len(records)} case(s).")
+
+        shape = (len(records), n_steps, len(self.fields)) + volume_shape
+        storage = np.float16 if self.dtype == 'float16' else np.uint16
+        out = np.lib.format.open_memmap(os.path.join(out_dir, 'tensors.npy'), mode='w+', dtype=storage, shape=shape)
+
+        maps = {}
+        overflow = 0
+        for n, record in enumerate(records):
+            for c, field in enumerate(self.fields):
+                offset, scale = self._scale(stats[field])
+                for start, values in self._blocks(record, field, maps):
+                    dense = np.zeros((len(values), n_dense), dtype=np.float32)
+                    dense[:, index_map] = (values - offset) / scale
+                    if self.dtype == 'float16':
+                        overflow += int(np.count_nonzero(np.abs(dense) > np.finfo(np.float16).max))
+                        block = dense.astype(np.float16)
+                    else:
+                        block = to_bfloat16(dense)
+                    out[n, start:start + len(values), c] = block.reshape((len(values),) + volume_shape)
+        out.flush()
+        del out
+        if overflow:
+            self.logger.warning(f"{overflow} value(s) overflow float16 after normalization; use bfloat16.")
+
+        manifest = {'file': 'tensors.npy', 'mask': 'mask.npy', 'layout': 'N T C D H W', 'shape': list(shape),
+                    'dtype': self.dtype, 'storage_dtype': np.dtype(storage).name,
+                    'fields': self.fields, 'fidelity': fidelity, 'n_steps': n_steps,
+                    'cart_dims': list(cart_dims), 'volume_shape': list(volume_shape),
+                    'active_cells': int(index_map.size),
+                    'normalization': {'method': self.normalization,
+                                      **{f: {**stats[f], 'offset': self._scale(stats[f])[0],
+                                             'scale': self._scale(stats[f])[1]} for f in self.fields}},
+                    'cases': [r['case_name'] for r in records],
+                    'params': [r.get('params', {}) for r in records],
+                    'store': os.path.abspath(self.store.root), 'key': key,
+                    'created': datetime.now().isoformat(timespec='seconds')}
+        with open(os.path.join(out_dir, TENSOR_MANIFEST), 'w') as f:
+            json.dump(manifest, f, indent=2)
+        self.logger.info(f"Tensors of shape {shape} ({self.dtype}) exported to '{out_dir}'.")
+        return manifest
+
+
+def read_tensor_manifest(out_dir: str) -> Dict:
+    """Manifest of an exported tensor folder."""
+    with open(os.path.join(out_dir, TENSOR_MANIFEST)) as f:
+        return json.load(f)
+
+
+def open_tensors(out_dir: str) -> np.ndarray:
+    """Memory-map the exported tensor (read-only), as stored (uint16 bit patterns for bfloat16)."""
+    return np.load(os.path.join(out_dir, read_tensor_manifest(out_dir)['file']), mmap_mode='r')
+
+
+def denormalize(values: np.ndarray, manifest: Dict, field: str) -> np.ndarray:
+    """Physical values of one field from its normalized values (float32 or float16)."""
+    stats = manifest['normalization'][field.upper()]
+    return np.asarray(values, dtype=np.float32) * stats['scale'] + stats['offset']
@@ -0,0 +1,259 @@
+import os
+import logging
+import numpy as np
+import torch
+import torch.multiprocessing as mp
+
+from torch.utils.data import DataLoader, Dataset, IterableDataset, get_worker_info
+from typing import Dict, Iterator, List, Optional, Sequence, Tuple
+
+from dataset_store import ShardedStore
+from tensor_export import open_tensors, read_tensor_manifest
+
+
+class ShardWindowDataset(IterableDataset):
+    def __init__(self, store: ShardedStore, fields: Sequence[str] = ('SG',),
+                 records: Optional[Sequence[Dict]] = None, window: int = 1,
+                 horizon: int = 1, stride: int = 1, shuffle: bool = False,
+                 seed: int = 0, fill: float = 0.0, dtype: np.dtype = np.float32) -> None:
+        """PyTorch dataset of time windows read from a `ShardedStore`.
+
+        Each sample is a pair (inputs, targets) of contiguous tensors of shape
+        (window, C, D, H, W) and (horizon, C, D, H, W), with one channel per
+        field and (D, H, W) = (K, J, I), with D = 1 for VE cases. Batches
+        from a DataLoader are then (N, T, C, D, H, W), ready for Conv3d/LSTM
+        models without a permute.
+        With window = horizon = 1 the samples are the (t, t+1) pairs.
+
+        Fields are read from the memory-mapped shards and scattered straight
+        into the dense output buffer, which `torch.from_numpy` wraps without
+        copying. Windows are grouped by shard and split across DataLoader
+        workers, so each worker maps only the shards it reads.
+
+        Parameters
+        ----------
+        store : ShardedStore
+            Store to read from.
+        fields : Sequence[str]
+            Fields used as channels, e.g. ('SG',) or ('P', 'SG').
+        records : Sequence[Dict], optional
+            Case records of one fidelity, e.g. from `store.select(fidelity='3d')`;
+            all cases by default.
+        window : int
+            Number of input timesteps.
+        horizon : int
+            Number of target timesteps following the inputs.
+        stride : int
+            Step between the first timesteps of consecutive windows.
+        shuffle : bool
+            Shuffle the shard order and the windows within each shard at
+            every epoch (see `set_epoch`).
+        seed : int
+            Seed of the shuffling.
+        fill : float
+            Value of inactive cells.
+        dtype : np.dtype
+            Output dtype.
+        """
+        super().__init__()
+        self.store = store
+        self.fields = [f.upper() for f in fields]
+        self.records = list(records) if records is not None else list(store.manifest().values())
+        self.window = window
+        self.horizon = horizon
+        self.stride = stride
+        self.shuffle = shuffle
+        self.seed = seed
+        self.fill = fill
+        self.dtype = np.dtype(dtype)
+        # shared with the (persistent) DataLoader workers, so set_epoch reaches them
+        self._epoch = mp.Value('q', 0)
+        self.logger = logging.getLogger("SimulationDatasetLogger")
+
+        fidelities = {r.get('fidelity', '3d') for r in self.records}
+        if len(fidelities) > 1:
+            self.logger.error(f"Cases of different fidelities {sorted(fidelities)} cannot be mixed.")
+            raise ValueError(f"Cases of different fidelities {sorted(fidelities)} cannot be mixed.")
+        self.fidelity = fidelities.pop() if fidelities else '3d'
+
+        index_map, cart_dims = store.grid(self.fidelity)
+        self.index_map = index_map.astype(np.int64)
+        # VE cases live on the (I, J) top surface grid
+        self.cart_dims = tuple(cart_dims) + (1,) * (3 - len(cart_dims))
+        # Fortran-order (I, J, K) linear indices are C-order (K, J, I) ones
+        self.volume_shape = tuple(reversed(self.cart_dims))
+
+        for record in self.records:
+            missing = [f for f in self.fields if f not in record.get('fields', [])]
+            if missing:
+                self.logger.error(f"Case '{record['case_name']}' has no field(s) {missing}.")
+                raise ValueError(f"Case '{record['case_name']}' has no field(s) {missing}.")
+
+        self.windows = self._windows()
+
+    def _windows(self) -> List[Tuple[int, int]]:
+        """(record index, first timestep) of every window, grouped by shard."""
+        length = self.window + self.horizon
+        out = []
+        for r in sorted(range(len(self.records)), key=lambda r: (self.records[r]['shard'], self.records[r]['offset'])):
+            for t in range(0, self.records[r]['n_steps'] - length + 1, self.stride):
+                out.append((r, t))
+        return out
+
+    def __len__(self) -> int:
+        return len(self.windows)
+
+    @property
+    def epoch(self) -> int:
+        return self._epoch.value
+
+    def set_epoch(self, epoch: int) -> None:
+        """Select the shuffling of the next epoch, in this process and the loader workers."""
+        self._epoch.value = epoch
+
+    def _worker_windows(self) -> List[Tuple[int, int]]:
+        """Windows of the current DataLoader worker: a contiguous run of shards."""
+        windows = self.windows
+        if self.shuffle:
+            rng = np.random.default_rng((self.seed, self.epoch))
+            by_shard = {}
+            for w in windows:
+                by_shard.setdefault(self.records[w[0]]['shard'], []).append(w)
+            shards = list(by_shard)
+            rng.shuffle(shards)
+            windows = []
+            for shard in shards:
+                group = by_shard[shard]
+                windows += [group[i] for i in rng.permutation(len(group))]
+
+        info = get_worker_info()
+        if info is None:
+            return windows
+        bounds = np.linspace(0, len(windows), info.num_workers + 1).astype(int)
+        return windows[bounds[info.id]:bounds[info.id + 1]]
+
+    def _scatter(self, values: np.ndarray, out: np.ndarray) -> None:
+        """Scatter (T, active cells) values into a (T, D*H*W) dense buffer."""
+        out[:, self.index_map] = values
+
+    def __iter__(self) -> Iterator[Tuple[torch.Tensor, torch.Tensor]]:
+        maps = {}
+        length = self.window + self.horizon
+        n_dense = int(np.prod(self.cart_dims))
+
+        for r, t in self._worker_windows():
+            record = self.records[r]
+            buf = np.full((length, len(self.fields), n_dense), self.fill, dtype=self.dtype)
+            for c, field in enumerate(self.fields):
+                key = (record['shard'], field)
+                if key not in maps:
+                    maps[key] = self.store.open_field(record['shard'], field)
+                self._scatter(maps[key][record['offset'], t:t + length], buf[:, c])
+
+            sample = torch.from_numpy(buf.reshape((length, len(self.fields)) + self.volume_shape))
+            yield sample[:self.window], sample[self.window:]
+
+
+class TensorWindowDataset(Dataset):
+    def __init__(self, out_dir: str, window: int = 1, horizon: int = 1, stride: int = 1) -> None:
+        """PyTorch dataset of time windows of tensors exported by `TensorExport`.
+
+        Samples are (inputs, targets) of shape (window, C, D, H, W) and
+        (horizon, C, D, H, W), already normalized and in half precision
+        (float16 or bfloat16, see the manifest). A window is a contiguous
+        slice of the memory-mapped tensor, so no scatter, cast or permute
+        is done per sample.
+
+        Parameters
+        ----------
+        out_dir : str
+            Folder written by `TensorExport.export`.
+        window : int
+            Number of input timesteps.
+        horizon : int
+            Number of target timesteps following the inputs.
+        stride : int
+            Step between the first timesteps of consecutive windows.
+        """
+        super().__init__()
+        self.manifest = read_tensor_manifest(out_dir)
+        self.out_dir = out_dir
+        self.window = window
+        self.horizon = horizon
+        self.bfloat16 = self.manifest['dtype'] == 'bfloat16'
+        self.mask = torch.from_numpy(np.load(os.path.join(out_dir, self.manifest['mask'])).astype(bool))
+        n_cases, n_steps = self.manifest['shape'][:2]
+        self.windows = [(n, t) for n in range(n_cases)
+                        for t in range(0, n_steps - window - horizon + 1, stride)]
+        self._tensors = None
+
+    def __len__(self) -> int:
+        return len(self.windows)
+
+    def __getitem__(self, i: int) -> Tuple[torch.Tensor, torch.Tensor]:
+        # opened lazily, so each DataLoader worker maps the file itself
+        if self._tensors is None:
+            self._tensors = open_tensors(self.out_dir)
+        n, t = self.windows[i]
+        buf = np.array(self._tensors[n, t:t + self.window + self.horizon])
+        sample = torch.from_numpy(buf.view(np.int16)).view(torch.bfloat16) if self.bfloat16 else torch.from_numpy(buf)
+        return sample[:self.window], sample[self.window:]
+
+
+def make_loader(dataset: Dataset, batch_size: int = 8, workers: int = 4,
+                pin_memory: bool = True, prefetch_factor: int = 4, shuffle: bool = False) -> DataLoader:
+    """
+    DataLoader over a window dataset that keeps batches ahead of the model
+    in pinned memory.
+
+    Parameters
+    ----------
+    dataset : Dataset
+        Dataset to load (`ShardWindowDataset` or `TensorWindowDataset`).
+    batch_size : int
+        Number of windows per batch.
+    workers : int
+        Number of loader processes (0 loads in the main process).
+    pin_memory : bool
+        Place batches in page-locked memory for asynchronous GPU copies.
+    prefetch_factor : int
+        Batches loaded in advance by each worker.
+    shuffle : bool
+        Shuffle the windows of a `TensorWindowDataset` at every epoch
+        (a `ShardWindowDataset` shuffles itself).
+
+    Returns
+    -------
+    DataLoader
+        Loader yielding (inputs, targets) of shape (N, T, C, D, H, W).
+    """
+    options = {'prefetch_factor': prefetch_factor, 'persistent_workers': True} if workers > 0 else {}
+    return DataLoader(dataset, batch_size=batch_size, num_workers=workers,
+                      shuffle=shuffle and not isinstance(dataset, IterableDataset),
+                      pin_memory=pin_memory and torch.cuda.is_available(), **options)
+
+
+def prefetch_to_device(loader: DataLoader, device: torch.device) -> Iterator[Tuple[torch.Tensor, ...]]:
+    """
+    Iterate over a loader while copying the next batch to the device, so
+    host-to-device transfers overlap with the computation on the current one.
+    """
+    device = torch.device(device)
+    if device.type != 'cuda':
+        for batch in loader:
+            yield tuple(x.to(device) for x in batch)
+        return
+
+    stream = torch.cuda.Stream(device)
+    pending = None
+    for batch in loader:
+        with torch.cuda.stream(stream):
+            ready = tuple(x.to(device, non_blocking=True) for x in batch)
+        if pending is not None:
+            yield pending
+        torch.cuda.current_stream(device).wait_stream(stream)
+        for x in ready:
+            x.record_stream(torch.cuda.current_stream(device))
+        pending = ready
+    if pending is not None:
+        yield pending
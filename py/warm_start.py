@@ -0,0 +1,96 @@
+import os
+import logging
+import numpy as np
+
+from typing import Dict, List, Tuple
+
+from run_catalog import RunCatalog
+from sweep_design import SWEPT_SECTIONS
+
+
+# Parameters derived from others (brine properties), left out of the distance
+DERIVED_PARAMS = ('Fluid.rhow', 'Fluid.muw')
+
+# Columns that must match for a donor to be on the same grid and model
+SAME_MODEL_COLUMNS = ('Grid.cache_key', 'Grid.file_path', 'Grid.coarsen', 'Pre-Processing.model_type')
+
+
+def _columns(case: Dict) -> Dict[str, object]:
+    return {f"{section}.{key}": value for section, content in case.items() if isinstance(content, dict)
+            for key, value in content.items()}
+
+
+def nearest_cases(runs: List[Dict], case: Dict, neighbours: int = 2,
+                  radius: float = 0.25) -> List[Tuple[str, float]]:
+    """
+    Donors of the warm start of a case: the completed runs nearest to it
+    in parameter space, with inverse-distance weights.
+
+    Distances are Euclidean over the numeric parameters of the Fluid,
+    Initial Conditions, Wells and Schedule sections that vary among the
+    runs, each scaled by its range. Only runs on the same grid and model,
+    with an HDF5 store, within `radius` are considered; a run with the
+    same parameters is the only donor.
+
+    Parameters
+    ----------
+    runs : List[Dict]
+        Completed runs of the `RunCatalog`.
+    case : Dict
+        Parameters of the case.
+    neighbours : int
+        Maximum number of donors.
+    radius : float
+        Maximum scaled distance of a donor.
+
+    Returns
+    -------
+    List[Tuple[str, float]]
+        (output file, weight) of each donor, weights summing to 1; empty if
+        no run is close enough.
+    """
+    columns = _columns(case)
+    name = case['Pre-Processing']['case_name']
+    runs = [r for r in runs if r['case_name'] != name and str(r.get('output_file', '')).endswith('.h5')
+            and os.path.isfile(r['output_file'])
+            and all(str(r.get(c)) == str(columns.get(c)) for c in SAME_MODEL_COLUMNS if c in columns)]
+    if not runs:
+        return []
+
+    keys = [k for k, v in columns.items() if k.split('.')[0] in SWEPT_SECTIONS and k not in DERIVED_PARAMS
+            and isinstance(v, (int, float)) and not isinstance(v, bool)
+            and all(isinstance(r.get(k), (int, float)) for r in runs)]
+    X = np.array([[float(r[k]) for k in keys] for r in runs]).reshape(len(runs), len(keys))
+    x = np.array([float(columns[k]) for k in keys])
+    span = np.vstack([X, x]).max(axis=0) - np.vstack([X, x]).min(axis=0)
+    varied = span > 0
+    d = np.sqrt((((X[:, varied] - x[varied]) / span[varied]) ** 2).sum(axis=1))
+
+    order = [i for i in np.argsort(d, kind='stable')[:neighbours] if d[i] <= radius]
+    if not order:
+        return []
+    if d[order[0]] == 0:
+        return [(runs[order[0]]['output_file'], 1.0)]
+    w = 1 / d[order]
+    return [(runs[i]['output_file'], float(wi)) for i, wi in zip(order, w / w.sum())]
+
+
+def assign_warm_starts(cases: List[Dict], catalog: RunCatalog, neighbours: int = 2, radius: float = 0.25) -> int:
+    """
+    Set `[Solver] warm_start_files` and `warm_start_weights` of each case
+    from the nearest completed runs of the catalog (see `nearest_cases`),
+    for `WarmStartModelPUMLE.m`. Cases with an adaptive schedule get no
+    donors, since their timesteps follow the iteration counts. Returns the
+    number of cases with donors.
+    """
+    runs = catalog.select(status='done')
+    n = 0
+    for case in cases:
+        adaptive = str(case.get('Schedule', {}).get('mode', '')).lower() == 'adaptive'
+        donors = [] if adaptive else nearest_cases(runs, case, neighbours, radius)
+        solver = case.setdefault('Solver', {})
+        solver['warm_start_files'] = ';'.join(f for f, _ in donors)
+        solver['warm_start_weights'] = ' '.join(f"{w:.6g}" for _, w in donors)
+        n += bool(donors)
+    logging.getLogger("PUMLELogger").info(f"Warm start: {n} of {len(cases)} case(s) seeded from completed runs.")
+    return n
@@ -0,0 +1,95 @@
+import re
+import itertools
+
+from typing import Dict, List, Optional, Sequence, Tuple
+
+
+# 'NAME: (I, J, K_min, K_max[, rate])'
+WELL_PATTERN = re.compile(r"([\w-]+)\s*:\s*\(([^)]*)\)")
+
+
+def parse_wells_list(wells_list: str) -> List[Dict]:
+    """
+    Parse a `[Wells] wells_list`, e.g. 'NA1A: (38, 36, 6, 11) & RJS16: (12, 14, 6, 11, 1e5)',
+    as in `parseWellsPUMLE.m`.
+
+    Parameters
+    ----------
+    wells_list : str
+        Wells separated by '&', given by their logical grid coordinates
+        (I, J, K_min, K_max) and an optional injection rate [m3/year].
+
+    Returns
+    -------
+    List[Dict]
+        Name, i, j, k_min, k_max and rate (None when not given) of each well.
+
+    Raises
+    ------
+    ValueError
+        If no well is found or a well is malformed.
+    """
+    wells = []
+    for name, values in WELL_PATTERN.findall(wells_list):
+        try:
+            v = [float(x) for x in values.split(',')]
+        except ValueError:
+            raise ValueError(f"Invalid well '{name}': non-numeric coordinates '{values}'.")
+        if len(v) not in (4, 5) or v[2] > v[3]:
+            raise ValueError(f"Invalid well '{name}': expected (I, J, K_min, K_max[, rate]).")
+        i, j, k_min, k_max = (int(x) for x in v[:4])
+        wells.append({'name': name, 'i': i, 'j': j, 'k_min': k_min, 'k_max': k_max,
+                      'rate': v[4] if len(v) == 5 else None})
+    if not wells:
+        raise ValueError(f"No well found in wells_list '{wells_list}'.")
+    return wells
+
+
+def format_wells_list(wells: Sequence[Dict]) -> str:
+    """Inverse of `parse_wells_list`."""
+    out = []
+    for w in wells:
+        coords = [w['i'], w['j'], w['k_min'], w['k_max']] + ([w['rate']] if w.get('rate') is not None else [])
+        out.append(f"{w['name']}: ({', '.join(f'{c:g}' for c in coords)})")
+    return ' & '.join(out)
+
+
+def placement_scenarios(wells_list: str, well: str, positions: Optional[Sequence[Tuple[int, int]]] = None,
+                        rates: Optional[Sequence[float]] = None) -> List[str]:
+    """
+    Scenarios of a well-placement/rate sweep: one well of a wells list is
+    moved to each candidate (I, J) column and given each candidate rate
+    (full factorial), the other wells are kept as they are.
+
+    The scenarios run in one MATLAB session with `GenerateDataset.run_well_sweep`.
+
+    Parameters
+    ----------
+    wells_list : str
+        Base wells list.
+    well : str
+        Name of the well that is moved.
+    positions : Sequence[Tuple[int, int]], optional
+        Candidate (I, J) columns; the base position by default.
+    rates : Sequence[float], optional
+        Candidate injection rates [m3/year]; the base rate by default.
+
+    Returns
+    -------
+    List[str]
+        Wells list of each scenario.
+    """
+    base = parse_wells_list(wells_list)
+    idx = next((n for n, w in enumerate(base) if w['name'] == well), None)
+    if idx is None:
+        raise ValueError(f"Well '{well}' is not in wells_list '{wells_list}'.")
+
+    positions = positions or [(base[idx]['i'], base[idx]['j'])]
+    rates = rates or [base[idx]['rate']]
+
+    scenarios = []
+    for (i, j), rate in itertools.product(positions, rates):
+        wells = [dict(w) for w in base]
+        wells[idx].update(i=int(i), j=int(j), rate=rate)
+        scenarios.append(format_wells_list(wells))
+    return scenarios